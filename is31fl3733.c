@@ -1,74 +1,517 @@
 #include "is31fl3733.h"
 
+#include <stddef.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#ifdef IS31FL3733_USE_STATS
+static uint32_t
+IS31FL3733_StatsStart (IS31FL3733 *device)
+{
+  return (device->clock != NULL) ? device->clock () : 0;
+}
+
+static void
+IS31FL3733_StatsFinish (IS31FL3733 *device, uint32_t start, uint8_t count, uint8_t status)
+{
+  uint32_t duration;
+  uint8_t bucket = 0;
+  
+  device->stats.transactions++;
+  device->stats.bytes += count;
+  if (status != 0)
+  {
+    device->stats.errors++;
+  }
+  // Add call duration to logarithmic histogram.
+  if (device->clock != NULL)
+  {
+    for (duration = device->clock () - start; (duration != 0) && (bucket < IS31FL3733_STATS_BUCKETS - 1); duration >>= 1)
+    {
+      bucket++;
+    }
+    device->stats.latency[bucket]++;
+  }
+}
+#endif
+
+void
+IS31FL3733_KeepStatus (IS31FL3733 *device, uint8_t status)
+{
+  // Keep first error until it is read.
+  if (device->status == 0)
+  {
+    device->status = status;
+  }
+}
+
+static uint8_t
+IS31FL3733_Write (IS31FL3733 *device, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  uint8_t status;
+  uint8_t attempt = 0;
+#ifdef IS31FL3733_USE_STATS
+  uint32_t start;
+#endif
+  
+  do
+  {
+#ifdef IS31FL3733_USE_STATS
+    start = IS31FL3733_StatsStart (device);
+#endif
+    // Write registers through transport, if attached.
+    if (device->transport != NULL)
+    {
+      status = device->transport->write (device->transport, device->address, reg_addr, buffer, count);
+    }
+    else
+    {
+      // Write registers with blocking I2C function.
+      status = device->i2c_write_reg (device->address, reg_addr, buffer, count);
+    }
+#ifdef IS31FL3733_USE_STATS
+    IS31FL3733_StatsFinish (device, start, count, status);
+#endif
+  }
+  // Repeat failed write, registers get the same values again.
+  while ((status != 0) && (attempt++ < IS31FL3733_RETRIES));
+  IS31FL3733_KeepStatus (device, status);
+  return status;
+}
+
+static uint8_t
+IS31FL3733_Read (IS31FL3733 *device, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  uint8_t status;
+  uint8_t attempt = 0;
+#ifdef IS31FL3733_USE_STATS
+  uint32_t start;
+#endif
+  
+  do
+  {
+#ifdef IS31FL3733_USE_STATS
+    start = IS31FL3733_StatsStart (device);
+#endif
+    // Read registers through transport, if attached.
+    if (device->transport != NULL)
+    {
+      status = device->transport->read (device->transport, device->address, reg_addr, buffer, count);
+    }
+    else
+    {
+      // Read registers with blocking I2C function.
+      status = device->i2c_read_reg (device->address, reg_addr, buffer, count);
+    }
+#ifdef IS31FL3733_USE_STATS
+    IS31FL3733_StatsFinish (device, start, count, status);
+#endif
+  }
+  // Repeat failed read.
+  while ((status != 0) && (attempt++ < IS31FL3733_RETRIES));
+  IS31FL3733_KeepStatus (device, status);
+  return status;
+}
+
+static void
+IS31FL3733_SetStaleBits (uint32_t *stale, uint8_t first, uint8_t count, uint8_t size)
+{
+  // Mark registers from first to last one within size.
+  for (; (count != 0) && (first < size); count--, first++)
+  {
+    *stale |= (uint32_t)1 << first;
+  }
+}
+
+static void
+IS31FL3733_SetDirtyBits (uint16_t *dirty, uint8_t first, uint8_t count)
+{
+  // Mark registers from first to last one within Page 1 or Page 2 LED registers.
+  for (; (count != 0) && (first < IS31FL3733_SW * IS31FL3733_CS); count--, first++)
+  {
+    dirty[first / IS31FL3733_CS] |= 0x0001 << (first % IS31FL3733_CS);
+  }
+}
+
+void
+IS31FL3733_MarkStale (IS31FL3733 *device, uint16_t reg_addr, uint8_t count)
+{
+  uint8_t addr = IS31FL3733_GET_ADDR(reg_addr);
+  
+  // Failed write may leave old values in device registers, shadow buffers keep intended values.
+  switch (IS31FL3733_GET_PAGE(reg_addr))
+  {
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDONOFF):
+      IS31FL3733_SetStaleBits (&device->leds_stale, addr, count, sizeof(device->leds));
+      break;
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDPWM):
+      // Flush writes PWM registers again.
+      IS31FL3733_SetDirtyBits (device->pwm_dirty, addr, count);
+      break;
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDABM):
+      // Flush writes mode registers again.
+      IS31FL3733_SetDirtyBits (device->modes_dirty, addr, count);
+      break;
+    case IS31FL3733_GET_PAGE(IS31FL3733_CR):
+      IS31FL3733_SetStaleBits (&device->config_stale, addr, count, IS31FL3733_CONFIG_SIZE);
+      break;
+  }
+}
+
+static uint8_t
+IS31FL3733_WritePaged (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t count)
+{
+  uint8_t status;
+  
+  // Select registers page.
+  status = IS31FL3733_SelectPage (device, IS31FL3733_GET_PAGE(reg_addr));
+  if (status == 0)
+  {
+    // Write values to registers.
+    status = IS31FL3733_Write (device, IS31FL3733_GET_ADDR(reg_addr), values, count);
+  }
+  // Remember registers, which may have old values in device.
+  if (status != 0)
+  {
+    IS31FL3733_MarkStale (device, reg_addr, count);
+  }
+  return status;
+}
+
+static uint8_t
+IS31FL3733_SendBatch (IS31FL3733 *device)
+{
+  uint8_t count;
+  
+  // Check pending coalesced registers.
+  count = device->batch_count;
+  if (count == 0)
+  {
+    return 0;
+  }
+  // Mark batch as sent before page select to avoid recursion.
+  device->batch_count = 0;
+  // Write coalesced values to registers in one burst.
+  return IS31FL3733_WritePaged (device, device->batch_addr, device->batch_buffer, count);
+}
+
 uint8_t
 IS31FL3733_ReadCommonReg (IS31FL3733 *device, uint8_t reg_addr)
 {
-  uint8_t reg_value;
+  uint8_t reg_value = 0;
   
-  // Read value from register.
-  device->i2c_read_reg (device->address, reg_addr, &reg_value, sizeof(uint8_t));
+  // Read value from register, failure is kept in device status.
+  IS31FL3733_ReadCommonRegs (device, reg_addr, &reg_value, sizeof(uint8_t));
   // Return register value.
   return reg_value;
 }
 
-void
+uint8_t
+IS31FL3733_ReadCommonRegs (IS31FL3733 *device, uint8_t reg_addr, uint8_t *values, uint8_t count)
+{
+  // Write pending coalesced registers to keep order of operations.
+  IS31FL3733_SendBatch (device);
+  // Read values from registers.
+  return IS31FL3733_Read (device, reg_addr, values, count);
+}
+
+uint8_t
 IS31FL3733_WriteCommonReg (IS31FL3733 *device, uint8_t reg_addr, uint8_t reg_value)
 {
+  // Write pending coalesced registers to keep order of operations.
+  IS31FL3733_SendBatch (device);
   // Write value to register.
-  device->i2c_write_reg (device->address, reg_addr, &reg_value, sizeof(uint8_t));
+  return IS31FL3733_Write (device, reg_addr, &reg_value, sizeof(uint8_t));
 }
 
-void
+uint8_t
 IS31FL3733_SelectPage (IS31FL3733 *device, uint8_t page)
 {
+  uint8_t status;
+  
+  // Skip page select if requested page is already active.
+  if (device->page == page)
+  {
+    return 0;
+  }
   // Unlock Command Register.
-  IS31FL3733_WriteCommonReg (device, IS31FL3733_PSWL, IS31FL3733_PSWL_ENABLE);
-  // Select requested page in Command Register.
-  IS31FL3733_WriteCommonReg (device, IS31FL3733_PSR, page);
+  status = IS31FL3733_WriteCommonReg (device, IS31FL3733_PSWL, IS31FL3733_PSWL_ENABLE);
+  if (status == 0)
+  {
+    // Select requested page in Command Register.
+    status = IS31FL3733_WriteCommonReg (device, IS31FL3733_PSR, page);
+  }
+  // Remember active page, it is unknown after failed select.
+  device->page = (status == 0) ? page : IS31FL3733_PAGE_UNKNOWN;
+  IS31FL3733_STATS_ADD (device, page_switches, 1);
+  return status;
 }
 
 uint8_t
 IS31FL3733_ReadPagedReg (IS31FL3733 *device, uint16_t reg_addr)
 {
-  uint8_t reg_value;
+  uint8_t reg_value = 0;
   
-  // Select register page.
-  IS31FL3733_SelectPage (device, IS31FL3733_GET_PAGE(reg_addr));
-  // Read value from register.
-  device->i2c_read_reg (device->address, IS31FL3733_GET_ADDR(reg_addr), &reg_value, sizeof(uint8_t));
+  // Read value from register, failure is kept in device status.
+  IS31FL3733_ReadPagedRegs (device, reg_addr, &reg_value, sizeof(uint8_t));
   // Return register value.
   return reg_value;
 }
 
-void
+uint8_t
+IS31FL3733_ReadPagedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t count)
+{
+  uint8_t status;
+  
+  // Write pending coalesced registers to keep order of operations.
+  IS31FL3733_SendBatch (device);
+  // Select registers page.
+  status = IS31FL3733_SelectPage (device, IS31FL3733_GET_PAGE(reg_addr));
+  if (status != 0)
+  {
+    return status;
+  }
+  // Read values from registers.
+  return IS31FL3733_Read (device, IS31FL3733_GET_ADDR(reg_addr), values, count);
+}
+
+uint8_t
 IS31FL3733_WritePagedReg (IS31FL3733 *device, uint16_t reg_addr, uint8_t reg_value)
 {
-  // Select register page.
-  IS31FL3733_SelectPage (device, IS31FL3733_GET_PAGE(reg_addr));
   // Write value to register.
-  device->i2c_write_reg (device->address, IS31FL3733_GET_ADDR(reg_addr), &reg_value, sizeof(uint8_t));
+  return IS31FL3733_WritePagedRegs (device, reg_addr, &reg_value, sizeof(uint8_t));
 }
 
-void
+uint8_t
 IS31FL3733_WritePagedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t count)
 {
-  // Select registers page.
-  IS31FL3733_SelectPage (device, IS31FL3733_GET_PAGE(reg_addr));
+  uint8_t status = 0;
+  uint8_t result;
+  
+  // Mirror writes to Page 3 registers, they can't be read back from device.
+  if ((IS31FL3733_GET_PAGE(reg_addr) == IS31FL3733_GET_PAGE(IS31FL3733_CR)) &&
+      (IS31FL3733_GET_ADDR(reg_addr) + count <= IS31FL3733_CONFIG_SIZE))
+  {
+    memcpy (&device->config[IS31FL3733_GET_ADDR(reg_addr)], values, count);
+  }
+  if (device->batch)
+  {
+    // Append values to pending burst if registers are adjacent and fit into buffer.
+    if ((device->batch_count != 0) &&
+        (reg_addr == device->batch_addr + device->batch_count) &&
+        (count <= IS31FL3733_BATCH_SIZE - device->batch_count))
+    {
+      memcpy (&device->batch_buffer[device->batch_count], values, count);
+      device->batch_count += count;
+      return 0;
+    }
+    // Write pending burst, it can't be extended.
+    status = IS31FL3733_SendBatch (device);
+    // Start new pending burst if values fit into buffer.
+    if (count <= IS31FL3733_BATCH_SIZE)
+    {
+      memcpy (device->batch_buffer, values, count);
+      device->batch_addr = reg_addr;
+      device->batch_count = count;
+      return status;
+    }
+  }
   // Write values to registers.
-  device->i2c_write_reg (device->address, IS31FL3733_GET_ADDR(reg_addr), values, count);
+  result = IS31FL3733_WritePaged (device, reg_addr, values, count);
+  // Return first error.
+  return (status != 0) ? status : result;
+}
+
+uint8_t
+IS31FL3733_WriteStridedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t offset, uint8_t stride, uint8_t count)
+{
+  uint8_t status = 0;
+  uint8_t result;
+  uint8_t span;
+  uint8_t i;
+  
+  // Calculate number of registers from first to last written register.
+  span = (count - 1) * stride + 1;
+  // Compare cost of one burst over full span with cost of separate writes.
+  if (span + IS31FL3733_BURST_OVERHEAD <= count * (1 + IS31FL3733_BURST_OVERHEAD))
+  {
+    // Write full span from buffer in one burst.
+    return IS31FL3733_WritePagedRegs (device, reg_addr + offset, &values[offset], span);
+  }
+  // Write registers one by one.
+  for (i = 0; i < count; i++)
+  {
+    result = IS31FL3733_WritePagedReg (device, reg_addr + offset, values[offset]);
+    // Keep first error, write remaining registers.
+    if (status == 0)
+    {
+      status = result;
+    }
+    offset += stride;
+  }
+  return status;
+}
+
+void
+IS31FL3733_BeginBatch (IS31FL3733 *device)
+{
+  // Enable coalescing of adjacent register writes.
+  device->batch = 1;
+}
+
+uint8_t
+IS31FL3733_EndBatch (IS31FL3733 *device)
+{
+  // Disable coalescing of register writes.
+  device->batch = 0;
+  // Write pending coalesced registers.
+  return IS31FL3733_SendBatch (device);
+}
+
+void
+IS31FL3733_SetTransport (IS31FL3733 *device, IS31FL3733_TRANSPORT *transport)
+{
+  // Check value marks transport set by application, not left in uninitialized structure.
+  device->transport = transport;
+  device->transport_check = ~(uintptr_t)transport;
+  // Device selects page again through new transport.
+  device->page = IS31FL3733_PAGE_UNKNOWN;
+}
+
+static void
+IS31FL3733_InitState (IS31FL3733 *device)
+{
+  // Drop transport not set with IS31FL3733_SetTransport.
+  if (device->transport_check != ~(uintptr_t)device->transport)
+  {
+    device->transport = NULL;
+  }
+  // Active page is unknown before first access.
+  device->page = IS31FL3733_PAGE_UNKNOWN;
+  // Drop pending coalesced registers and disable batch mode.
+  device->batch = 0;
+  device->batch_count = 0;
+#ifdef IS31FL3733_USE_STATS
+  // Count bus usage from initialization.
+  IS31FL3733_ResetStats (device);
+#endif
+  // PWM values are written without correction by default.
+  device->gamma = NULL;
+  device->brightness = 255;
+  // Clear shadow buffers.
+  memset (device->pwm, 0, sizeof(device->pwm));
+  memset (device->modes, 0, sizeof(device->modes));
+  memset (device->pwm_dirty, 0, sizeof(device->pwm_dirty));
+  memset (device->modes_dirty, 0, sizeof(device->modes_dirty));
+  memset (device->config, 0, sizeof(device->config));
+  // LEDs are turned off by reset or restored with load.
+  device->load = 0;
+  // Start without errors and stale registers.
+  device->status = 0;
+  device->leds_stale = 0;
+  device->config_stale = 0;
 }
 
 void
 IS31FL3733_Init (IS31FL3733 *device)
 {
+  // Device registers are cleared by reset, sync driver state.
+  IS31FL3733_InitState (device);
   // Read reset register to reset device.
   IS31FL3733_ReadPagedReg (device, IS31FL3733_RESET);
+  // Don't rely on Page Select register value after reset.
+  device->page = IS31FL3733_PAGE_UNKNOWN;
   // Clear software reset in configuration register.
   IS31FL3733_WritePagedReg (device, IS31FL3733_CR, IS31FL3733_CR_SSD);
   // Clear state of all LEDs in internal buffer and sync buffer to device.
   IS31FL3733_SetLEDState (device, IS31FL3733_CS, IS31FL3733_SW, IS31FL3733_LED_STATE_OFF);
 }
 
+static uint16_t
+IS31FL3733_SnapshotChecksum (IS31FL3733_SNAPSHOT *snapshot)
+{
+  uint8_t *data = snapshot->leds;
+  uint16_t count;
+  uint16_t sum1 = 0;
+  uint16_t sum2 = 0;
+  
+  // Fletcher-16 checksum of snapshot contents from leds to shorted.
+  for (count = offsetof(IS31FL3733_SNAPSHOT, shorted) + sizeof(snapshot->shorted) - offsetof(IS31FL3733_SNAPSHOT, leds); count != 0; count--)
+  {
+    sum1 = (sum1 + *data++) % 255;
+    sum2 = (sum2 + sum1) % 255;
+  }
+  return (sum2 << 8) | sum1;
+}
+
+uint8_t
+IS31FL3733_SaveSnapshot (IS31FL3733 *device, IS31FL3733_SNAPSHOT *snapshot)
+{
+  uint8_t status[2 * IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint8_t result;
+  
+  // Snapshot is valid only if device registers match shadow buffers.
+  snapshot->magic = 0;
+  result = IS31FL3733_Resync (device);
+  if (result == 0)
+  {
+    // Read adjacent open and short registers in one burst, they are compared on attach.
+    result = IS31FL3733_ReadPagedRegs (device, IS31FL3733_LEDOPEN, status, sizeof(status));
+  }
+  if (result != 0)
+  {
+    return result;
+  }
+  memcpy (snapshot->leds, device->leds, sizeof(snapshot->leds));
+  memcpy (snapshot->pwm, device->pwm, sizeof(snapshot->pwm));
+  memcpy (snapshot->modes, device->modes, sizeof(snapshot->modes));
+  memcpy (snapshot->config, device->config, sizeof(snapshot->config));
+  memcpy (snapshot->open, status, sizeof(snapshot->open));
+  memcpy (snapshot->shorted, &status[IS31FL3733_LEDSHORT - IS31FL3733_LEDOPEN], sizeof(snapshot->shorted));
+  snapshot->checksum = IS31FL3733_SnapshotChecksum (snapshot);
+  snapshot->magic = IS31FL3733_SNAPSHOT_MAGIC;
+  return 0;
+}
+
+IS31FL3733_ATTACH_RESULT
+IS31FL3733_Attach (IS31FL3733 *device, IS31FL3733_SNAPSHOT *snapshot)
+{
+  uint8_t status[2 * IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint8_t i;
+  
+  // Check that snapshot was saved completely by this driver version.
+  if ((snapshot->magic != IS31FL3733_SNAPSHOT_MAGIC) || (snapshot->checksum != IS31FL3733_SnapshotChecksum (snapshot)))
+  {
+    return IS31FL3733_ATTACH_INVALID;
+  }
+  // Restore shadow buffers without reset, registers are in sync with them.
+  IS31FL3733_InitState (device);
+  memcpy (device->leds, snapshot->leds, sizeof(device->leds));
+  memcpy (device->pwm, snapshot->pwm, sizeof(device->pwm));
+  memcpy (device->modes, snapshot->modes, sizeof(device->modes));
+  memcpy (device->config, snapshot->config, sizeof(device->config));
+  IS31FL3733_ComputeLoad (device);
+  // Verify readable registers: device responds and open/short results are kept, they are cleared by reset or power loss.
+  if (IS31FL3733_ReadPagedRegs (device, IS31FL3733_LEDOPEN, status, sizeof(status)) != 0)
+  {
+    return IS31FL3733_ATTACH_ERROR;
+  }
+  if ((memcmp (status, snapshot->open, sizeof(snapshot->open)) != 0) ||
+      (memcmp (&status[IS31FL3733_LEDSHORT - IS31FL3733_LEDOPEN], snapshot->shorted, sizeof(snapshot->shorted)) != 0))
+  {
+    return IS31FL3733_ATTACH_MISMATCH;
+  }
+  // Reset clears open/short registers, without detected open or short LED snapshot matches reset device too.
+  for (i = 0; (i < sizeof(snapshot->open)) && (snapshot->open[i] == 0) && (snapshot->shorted[i] == 0); i++);
+  if (i == sizeof(snapshot->open))
+  {
+    return IS31FL3733_ATTACH_UNVERIFIED;
+  }
+  return IS31FL3733_ATTACH_OK;
+}
+
 void
 IS31FL3733_SetGCC (IS31FL3733 *device, uint8_t gcc)
 {
@@ -90,6 +533,91 @@ IS31FL3733_SetCSPDR (IS31FL3733 *device, IS31FL3733_RESISTOR resistor)
   IS31FL3733_WritePagedReg (device, IS31FL3733_CSPDR, resistor);
 }
 
+uint8_t
+IS31FL3733_CorrectPWM (IS31FL3733 *device, uint8_t value)
+{
+  // Apply correction curve.
+  if (device->gamma != NULL)
+  {
+    value = device->gamma[value];
+  }
+  // Scale by brightness, 255 keeps value unchanged.
+  return (uint8_t)((value * (device->brightness + 1)) >> 8);
+}
+
+void
+IS31FL3733_CorrectPWMBuffer (IS31FL3733 *device, uint8_t *dst, uint8_t *src)
+{
+  uint16_t scale;
+  uint8_t i;
+  
+  scale = device->brightness + 1;
+  // Select loop outside of pass over frame, so each loop could be vectorized by compiler.
+  if (device->gamma != NULL)
+  {
+    for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+    {
+      dst[i] = (uint8_t)((device->gamma[src[i]] * scale) >> 8);
+    }
+  }
+  else if (scale != 256)
+  {
+    for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+    {
+      dst[i] = (uint8_t)((src[i] * scale) >> 8);
+    }
+  }
+  else
+  {
+    memcpy (dst, src, IS31FL3733_SW * IS31FL3733_CS);
+  }
+}
+
+void
+IS31FL3733_SetGamma (IS31FL3733 *device, const uint8_t *gamma)
+{
+  // Set correction table for next PWM values.
+  device->gamma = gamma;
+}
+
+void
+IS31FL3733_SetBrightness (IS31FL3733 *device, uint8_t brightness)
+{
+  // Set brightness scale for next PWM values.
+  device->brightness = brightness;
+}
+
+void
+IS31FL3733_StorePWM (IS31FL3733 *device, uint8_t offset, uint8_t value)
+{
+  // Replace PWM value in load of LED turned on.
+  if (device->leds[offset / 8] & (0x01 << (offset % 8)))
+  {
+    device->load += value - device->pwm[offset];
+  }
+  // Update LED PWM value in shadow buffer.
+  device->pwm[offset] = value;
+}
+
+void
+IS31FL3733_StoreLEDs (IS31FL3733 *device, uint8_t offset, uint8_t bits)
+{
+  uint8_t changed;
+  uint8_t i;
+  
+  // Add PWM values of LEDs turned on and subtract PWM values of LEDs turned off.
+  changed = device->leds[offset] ^ bits;
+  for (i = 0; changed >> i; i++)
+  {
+    if (changed & (0x01 << i))
+    {
+      device->load += (bits & (0x01 << i)) ? device->pwm[offset * 8 + i] : -device->pwm[offset * 8 + i];
+    }
+  }
+  // Update state of LEDs in shadow buffer.
+  device->leds[offset] = bits;
+}
+
 void
 IS31FL3733_SetLEDState (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_STATE state)
 {
@@ -108,12 +636,12 @@ IS31FL3733_SetLEDState (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_L
       if (state == IS31FL3733_LED_STATE_OFF)
       {
         // Clear bit for selected LED.
-        device->leds[offset] &= ~(0x01 << (cs % 8));
+        IS31FL3733_StoreLEDs (device, offset, device->leds[offset] & ~(0x01 << (cs % 8)));
       }
       else
       {
         // Set bit for selected LED.
-        device->leds[offset] |= 0x01 << (cs % 8);
+        IS31FL3733_StoreLEDs (device, offset, device->leds[offset] | (0x01 << (cs % 8)));
       }
       // Write updated LED state to device register.
       IS31FL3733_WritePagedReg (device, IS31FL3733_LEDONOFF + offset, device->leds[offset]);
@@ -127,14 +655,14 @@ IS31FL3733_SetLEDState (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_L
       if (state == IS31FL3733_LED_STATE_OFF)
       {
         // Clear 16 bits for selected row LEDs.
-        device->leds[offset    ] = 0x00;
-        device->leds[offset + 1] = 0x00;
+        IS31FL3733_StoreLEDs (device, offset    , 0x00);
+        IS31FL3733_StoreLEDs (device, offset + 1, 0x00);
       }
       else
       {
         // Set 16 bits for selected row LEDs.
-        device->leds[offset    ] = 0xFF;
-        device->leds[offset + 1] = 0xFF;
+        IS31FL3733_StoreLEDs (device, offset    , 0xFF);
+        IS31FL3733_StoreLEDs (device, offset + 1, 0xFF);
       }
       // Write updated LEDs state to device registers.
       IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDONOFF + offset, &device->leds[offset], IS31FL3733_CS / 8);
@@ -154,16 +682,16 @@ IS31FL3733_SetLEDState (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_L
         if (state == IS31FL3733_LED_STATE_OFF)
         {
           // Clear bit for selected LED.
-          device->leds[offset] &= ~(0x01 << (cs % 8));
+          IS31FL3733_StoreLEDs (device, offset, device->leds[offset] & ~(0x01 << (cs % 8)));
         }
         else
         {
           // Set bit for selected LED.
-          device->leds[offset] |= 0x01 << (cs % 8);
+          IS31FL3733_StoreLEDs (device, offset, device->leds[offset] | (0x01 << (cs % 8)));
         }
-        // Write updated LED state to device register.
-        IS31FL3733_WritePagedReg (device, IS31FL3733_LEDONOFF + offset, device->leds[offset]);
       }
+      // Write updated LEDs state to device registers.
+      IS31FL3733_WriteStridedRegs (device, IS31FL3733_LEDONOFF, device->leds, cs / 8, IS31FL3733_CS / 8, IS31FL3733_SW);
     }
     else
     {
@@ -174,14 +702,14 @@ IS31FL3733_SetLEDState (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_L
         if (state == IS31FL3733_LED_STATE_OFF)
         {
           // Clear all bits.
-          device->leds[(sw << 1)    ] = 0x00;
-          device->leds[(sw << 1) + 1] = 0x00;
+          IS31FL3733_StoreLEDs (device, (sw << 1)    , 0x00);
+          IS31FL3733_StoreLEDs (device, (sw << 1) + 1, 0x00);
         }
         else
         {
           // Set all bits.
-          device->leds[(sw << 1)    ] = 0xFF;
-          device->leds[(sw << 1) + 1] = 0xFF;
+          IS31FL3733_StoreLEDs (device, (sw << 1)    , 0xFF);
+          IS31FL3733_StoreLEDs (device, (sw << 1) + 1, 0xFF);
         }
       }
       // Write updated LEDs state to device registers.
@@ -195,6 +723,8 @@ IS31FL3733_SetLEDPWM (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value)
 {
   uint8_t offset;
   
+  // Apply correction curve and brightness.
+  value = IS31FL3733_CorrectPWM (device, value);
   // Check SW boundaries.
   if (sw < IS31FL3733_SW)
   {
@@ -204,19 +734,25 @@ IS31FL3733_SetLEDPWM (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value)
       // Set PWM of individual LED.
       // Calculate LED offset.
       offset = sw * IS31FL3733_CS + cs;
+      // Update LED PWM value in shadow buffer.
+      IS31FL3733_StorePWM (device, offset, value);
+      device->pwm_dirty[sw] &= ~(0x0001 << cs);
       // Write LED PWM value to device register.
       IS31FL3733_WritePagedReg (device, IS31FL3733_LEDPWM + offset, value);
     }
     else
     {
       // Set PWM of full row selected by SW.
+      // Calculate row offset.
+      offset = sw * IS31FL3733_CS;
+      // Update row PWM values in shadow buffer.
       for (cs = 0; cs < IS31FL3733_CS; cs++)
       {
-        // Calculate LED offset.
-        offset = sw * IS31FL3733_CS + cs;
-        // Write LED PWM value to device register.
-        IS31FL3733_WritePagedReg (device, IS31FL3733_LEDPWM + offset, value);
+        IS31FL3733_StorePWM (device, offset + cs, value);
       }
+      device->pwm_dirty[sw] = 0x0000;
+      // Write row PWM values to device registers in one burst.
+      IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDPWM + offset, &device->pwm[offset], IS31FL3733_CS);
     }
   }
   else
@@ -227,25 +763,22 @@ IS31FL3733_SetLEDPWM (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value)
       // Set PWM of full column selected by CS.
       for (sw = 0; sw < IS31FL3733_SW; sw++)
       {
-          // Calculate LED offset.
-          offset = sw * IS31FL3733_CS + cs;
-          // Write LED PWM value to device register.
-          IS31FL3733_WritePagedReg (device, IS31FL3733_LEDPWM + offset, value);
+        // Update LED PWM value in shadow buffer.
+        IS31FL3733_StorePWM (device, sw * IS31FL3733_CS + cs, value);
+        device->pwm_dirty[sw] &= ~(0x0001 << cs);
       }
+      // Write column PWM values to device registers.
+      IS31FL3733_WriteStridedRegs (device, IS31FL3733_LEDPWM, device->pwm, cs, IS31FL3733_CS, IS31FL3733_SW);
     }
     else
     {
       // Set PWM of all LEDs.
-      for (sw = 0; sw < IS31FL3733_SW; sw++)
-      {
-        for (cs = 0; cs < IS31FL3733_CS; cs++)
-        {
-          // Calculate LED offset.
-          offset = sw * IS31FL3733_CS + cs;
-          // Write LED PWM value to device register.
-          IS31FL3733_WritePagedReg (device, IS31FL3733_LEDPWM + offset, value);
-        }
-      }
+      // Update PWM values in shadow buffer, load of all LEDs turned on is replaced.
+      memset (device->pwm, value, sizeof(device->pwm));
+      memset (device->pwm_dirty, 0, sizeof(device->pwm_dirty));
+      IS31FL3733_ComputeLoad (device);
+      // Write PWM values to device registers in one burst.
+      IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDPWM, device->pwm, IS31FL3733_SW * IS31FL3733_CS);
     }
   }
 }
@@ -279,40 +812,566 @@ IS31FL3733_GetLEDStatus (IS31FL3733 *device, uint8_t cs, uint8_t sw)
   return IS31FL3733_LED_STATUS_NORMAL;
 }
 
+void
+IS31FL3733_StartLEDScan (IS31FL3733 *device, IS31FL3733_LED_SCAN *scan)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint8_t config[IS31FL3733_GET_ADDR(IS31FL3733_GCC) + 1];
+  
+  // Save configuration to restore after detection.
+  scan->cr = device->config[IS31FL3733_GET_ADDR(IS31FL3733_CR)];
+  scan->gcc = device->config[IS31FL3733_GET_ADDR(IS31FL3733_GCC)];
+  // Turn on all LEDs, only LEDs turned on are checked.
+  memset (leds, 0xFF, sizeof(leds));
+  IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDONOFF, leds, sizeof(leds));
+  // Clear OSD bit, detection starts on its rising edge.
+  if (scan->cr & IS31FL3733_CR_OSD)
+  {
+    IS31FL3733_WritePagedReg (device, IS31FL3733_CR, scan->cr & ~IS31FL3733_CR_OSD);
+  }
+  // Set OSD bit and minimal global current for detection in one burst.
+  config[IS31FL3733_GET_ADDR(IS31FL3733_CR)] = scan->cr | IS31FL3733_CR_OSD | IS31FL3733_CR_SSD;
+  config[IS31FL3733_GET_ADDR(IS31FL3733_GCC)] = 0x01;
+  IS31FL3733_WritePagedRegs (device, IS31FL3733_CR, config, sizeof(config));
+}
+
+static uint8_t
+IS31FL3733_CountBits (uint8_t *bitmask, uint8_t count)
+{
+  uint8_t total = 0;
+  uint8_t bits;
+  
+  while (count--)
+  {
+    // Count set bits in byte.
+    bits = *bitmask++;
+    bits = bits - ((bits >> 1) & 0x55);
+    bits = (bits & 0x33) + ((bits >> 2) & 0x33);
+    total += (bits + (bits >> 4)) & 0x0F;
+  }
+  return total;
+}
+
+void
+IS31FL3733_ReadLEDScan (IS31FL3733 *device, IS31FL3733_LED_SCAN *scan)
+{
+  uint8_t status[2 * IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint8_t config[IS31FL3733_GET_ADDR(IS31FL3733_GCC) + 1];
+  
+  // Read adjacent open and short registers in one burst.
+  IS31FL3733_ReadPagedRegs (device, IS31FL3733_LEDOPEN, status, sizeof(status));
+  memcpy (scan->open, status, sizeof(scan->open));
+  memcpy (scan->shorted, &status[IS31FL3733_LEDSHORT - IS31FL3733_LEDOPEN], sizeof(scan->shorted));
+  // Count faulty LEDs.
+  scan->open_count = IS31FL3733_CountBits (scan->open, sizeof(scan->open));
+  scan->short_count = IS31FL3733_CountBits (scan->shorted, sizeof(scan->shorted));
+  // Restore LED states.
+  IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDONOFF, device->leds, sizeof(device->leds));
+  // Restore configuration and global current.
+  config[IS31FL3733_GET_ADDR(IS31FL3733_CR)] = scan->cr;
+  config[IS31FL3733_GET_ADDR(IS31FL3733_GCC)] = scan->gcc;
+  IS31FL3733_WritePagedRegs (device, IS31FL3733_CR, config, sizeof(config));
+}
+
+void
+IS31FL3733_ScanLEDs (IS31FL3733 *device, IS31FL3733_LED_SCAN *scan, void (*delay_ms) (uint32_t ms))
+{
+  // Start open/short detection.
+  IS31FL3733_StartLEDScan (device, scan);
+  // Wait for detection to complete.
+  delay_ms (IS31FL3733_LED_SCAN_TIME);
+  // Read detection results and restore configuration.
+  IS31FL3733_ReadLEDScan (device, scan);
+}
+
+IS31FL3733_LED_STATUS
+IS31FL3733_GetScanStatus (IS31FL3733_LED_SCAN *scan, uint8_t cs, uint8_t sw)
+{
+  uint8_t offset;
+  
+  // Check CS and SW boundaries.
+  if ((cs < IS31FL3733_CS) && (sw < IS31FL3733_SW))
+  {
+    // Calculate LED bit offset.
+    offset = (sw << 1) + (cs / 8);
+    if (scan->open[offset] & (0x01 << (cs % 8)))
+    {
+      return IS31FL3733_LED_STATUS_OPEN;
+    }
+    if (scan->shorted[offset] & (0x01 << (cs % 8)))
+    {
+      return IS31FL3733_LED_STATUS_SHORT;
+    }
+    return IS31FL3733_LED_STATUS_NORMAL;
+  }
+  // Unknown status for nonexistent LED.
+  return IS31FL3733_LED_STATUS_UNKNOWN;
+}
+
+static void
+IS31FL3733_WriteLEDs (IS31FL3733 *device, const uint8_t *leds)
+{
+  uint8_t first;
+  uint8_t last;
+  uint8_t gap;
+  
+  for (first = 0; first < sizeof(device->leds); first = last)
+  {
+    // Skip unchanged registers.
+    if (leds[first] == device->leds[first])
+    {
+      IS31FL3733_STATS_ADD (device, elided, 1);
+      last = first + 1;
+      continue;
+    }
+    // Extend burst over changed registers and short gaps of unchanged ones.
+    for (last = first + 1, gap = 0; (last < sizeof(device->leds)) && (gap <= IS31FL3733_BURST_OVERHEAD); last++)
+    {
+      gap = (leds[last] == device->leds[last]) ? gap + 1 : 0;
+    }
+    last -= gap;
+    // Update shadow and write changed registers.
+    for (gap = first; gap < last; gap++)
+    {
+      IS31FL3733_StoreLEDs (device, gap, leds[gap]);
+    }
+    IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDONOFF + first, &device->leds[first], last - first);
+  }
+}
+
+void
+IS31FL3733_PackState (uint8_t *leds, const uint8_t *values, uint8_t threshold)
+{
+  uint8_t sw;
+#if defined(__SSE2__)
+  __m128i bias = _mm_set1_epi8 ((char)0x80);
+  __m128i limit = _mm_set1_epi8 ((char)(threshold ^ 0x80));
+  uint16_t mask;
+  
+  for (sw = 0; sw < IS31FL3733_SW; sw++)
+  {
+    // Unsigned compare of 16 values with threshold, one mask bit per CS.
+    mask = (uint16_t)_mm_movemask_epi8 (_mm_cmpgt_epi8 (_mm_xor_si128 (_mm_loadu_si128 ((const __m128i *)&values[sw * IS31FL3733_CS]), bias), limit));
+    leds[(sw << 1)    ] = (uint8_t)mask;
+    leds[(sw << 1) + 1] = (uint8_t)(mask >> 8);
+  }
+#else
+  uint8_t i;
+  uint8_t bits;
+  
+  for (sw = 0; sw < IS31FL3733_SW * IS31FL3733_CS / 8; sw++)
+  {
+    // Compare results are 0 or 1, shifted without branches.
+    bits = 0;
+    for (i = 0; i < 8; i++)
+    {
+      bits |= (uint8_t)((values[i] > threshold) << i);
+    }
+    leds[sw] = bits;
+    values += 8;
+  }
+#endif
+}
+
+void
+IS31FL3733_PackState4 (uint8_t *leds, const uint8_t *values, uint8_t threshold)
+{
+  uint8_t i;
+  uint8_t j;
+  uint8_t bits;
+  
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS / 8; i++)
+  {
+    // Two LEDs in each byte, high nibble first.
+    bits = 0;
+    for (j = 0; j < 4; j++)
+    {
+      bits |= (uint8_t)(((values[j] >> 4) > threshold) << (j * 2));
+      bits |= (uint8_t)(((values[j] & 0x0F) > threshold) << (j * 2 + 1));
+    }
+    leds[i] = bits;
+    values += 4;
+  }
+}
+
 void
 IS31FL3733_SetState (IS31FL3733 *device, uint8_t *states)
+{
+  IS31FL3733_SetStateThreshold (device, states, 0);
+}
+
+void
+IS31FL3733_SetStateThreshold (IS31FL3733 *device, const uint8_t *values, uint8_t threshold)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  
+  IS31FL3733_PackState (leds, values, threshold);
+  IS31FL3733_WriteLEDs (device, leds);
+}
+
+void
+IS31FL3733_SetStateThreshold4 (IS31FL3733 *device, const uint8_t *values, uint8_t threshold)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  
+  IS31FL3733_PackState4 (leds, values, threshold);
+  IS31FL3733_WriteLEDs (device, leds);
+}
+
+void
+IS31FL3733_SetStatePacked (IS31FL3733 *device, const uint8_t *leds)
+{
+  IS31FL3733_WriteLEDs (device, leds);
+}
+
+void
+IS31FL3733_SetPWM (IS31FL3733 *device, uint8_t *values)
+{
+  // Copy LED PWM values to shadow buffer applying correction curve and brightness.
+  if (values != device->pwm)
+  {
+    IS31FL3733_CorrectPWMBuffer (device, device->pwm, values);
+  }
+  // All PWM registers will be in sync with shadow buffer.
+  memset (device->pwm_dirty, 0, sizeof(device->pwm_dirty));
+  // Full frame is replaced, load is summed once with frame write.
+  IS31FL3733_ComputeLoad (device);
+  // Write LED PWM values to device registers.
+  IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDPWM, device->pwm, IS31FL3733_SW * IS31FL3733_CS);
+}
+
+static uint8_t
+IS31FL3733_UpdateReg (uint8_t *shadow, uint16_t *dirty, uint8_t cs, uint8_t sw, uint8_t value)
+{
+  uint8_t offset;
+  
+  // Calculate LED offset.
+  offset = sw * IS31FL3733_CS + cs;
+  // Mark register as changed only if value differs from shadow.
+  if (shadow[offset] != value)
+  {
+    shadow[offset] = value;
+    dirty[sw] |= 0x0001 << cs;
+    return 0;
+  }
+  return 1;
+}
+
+uint8_t
+IS31FL3733_UpdateLEDRegs (uint8_t *shadow, uint16_t *dirty, uint8_t cs, uint8_t sw, uint8_t value)
+{
+  uint8_t unchanged = 0;
+  
+  // Check SW boundaries.
+  if (sw < IS31FL3733_SW)
+  {
+    // Check CS boundaries.
+    if (cs < IS31FL3733_CS)
+    {
+      // Update individual LED.
+      unchanged += IS31FL3733_UpdateReg (shadow, dirty, cs, sw, value);
+    }
+    else
+    {
+      // Update full row selected by SW.
+      for (cs = 0; cs < IS31FL3733_CS; cs++)
+      {
+        unchanged += IS31FL3733_UpdateReg (shadow, dirty, cs, sw, value);
+      }
+    }
+  }
+  else
+  {
+    // Check CS boundaries.
+    if (cs < IS31FL3733_CS)
+    {
+      // Update full column selected by CS.
+      for (sw = 0; sw < IS31FL3733_SW; sw++)
+      {
+        unchanged += IS31FL3733_UpdateReg (shadow, dirty, cs, sw, value);
+      }
+    }
+    else
+    {
+      // Update all LEDs.
+      for (sw = 0; sw < IS31FL3733_SW; sw++)
+      {
+        for (cs = 0; cs < IS31FL3733_CS; cs++)
+        {
+          unchanged += IS31FL3733_UpdateReg (shadow, dirty, cs, sw, value);
+        }
+      }
+    }
+  }
+  return unchanged;
+}
+
+static uint8_t
+IS31FL3733_UpdatePWMReg (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value)
+{
+  uint8_t offset;
+  
+  // Calculate LED offset.
+  offset = sw * IS31FL3733_CS + cs;
+  // Mark register as changed only if value differs from shadow.
+  if (device->pwm[offset] != value)
+  {
+    IS31FL3733_StorePWM (device, offset, value);
+    device->pwm_dirty[sw] |= 0x0001 << cs;
+    return 0;
+  }
+  return 1;
+}
+
+void
+IS31FL3733_UpdateLEDPWM (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value)
+{
+  uint8_t cs_first = (cs < IS31FL3733_CS) ? cs : 0;
+  uint8_t cs_last = (cs < IS31FL3733_CS) ? cs + 1 : IS31FL3733_CS;
+  uint8_t sw_first = (sw < IS31FL3733_SW) ? sw : 0;
+  uint8_t sw_last = (sw < IS31FL3733_SW) ? sw + 1 : IS31FL3733_SW;
+  uint8_t unchanged = 0;
+  
+  // Apply correction curve and brightness.
+  value = IS31FL3733_CorrectPWM (device, value);
+  // Update individual LED, full row selected by SW, full column selected by CS or all LEDs in shadow buffer.
+  for (sw = sw_first; sw < sw_last; sw++)
+  {
+    for (cs = cs_first; cs < cs_last; cs++)
+    {
+      unchanged += IS31FL3733_UpdatePWMReg (device, cs, sw, value);
+    }
+  }
+  IS31FL3733_STATS_ADD (device, elided, unchanged);
+}
+
+void
+IS31FL3733_UpdatePWM (IS31FL3733 *device, uint8_t *values)
 {
   uint8_t sw;
   uint8_t cs;
-  uint8_t offset;
+  uint8_t unchanged = 0;
   
-  // Set state of all LEDs.
+  // Update PWM of all LEDs in shadow buffer.
   for (sw = 0; sw < IS31FL3733_SW; sw++)
   {
     for (cs = 0; cs < IS31FL3733_CS; cs++)
     {
-      // Calculate LED bit offset.
-      offset = (sw << 1) + (cs / 8);
-      // Update state of LED in internal buffer.
-      if (states[sw * IS31FL3733_CS + cs] == 0)
+      unchanged += IS31FL3733_UpdatePWMReg (device, cs, sw, IS31FL3733_CorrectPWM (device, values[sw * IS31FL3733_CS + cs]));
+    }
+  }
+  IS31FL3733_STATS_ADD (device, elided, unchanged);
+}
+
+void
+IS31FL3733_UpdateRawPWM (IS31FL3733 *device, const uint8_t *values)
+{
+  uint8_t sw;
+  uint8_t cs;
+  uint8_t unchanged = 0;
+  
+  // Update PWM of all LEDs in shadow buffer without correction.
+  for (sw = 0; sw < IS31FL3733_SW; sw++)
+  {
+    for (cs = 0; cs < IS31FL3733_CS; cs++)
+    {
+      unchanged += IS31FL3733_UpdatePWMReg (device, cs, sw, values[sw * IS31FL3733_CS + cs]);
+    }
+  }
+  IS31FL3733_STATS_ADD (device, elided, unchanged);
+}
+
+uint8_t
+IS31FL3733_FlushRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *shadow, uint16_t *dirty, uint8_t rows)
+{
+  uint16_t mask;
+  uint8_t status = 0;
+  uint8_t result;
+  uint8_t sw;
+  uint8_t cs;
+  uint8_t offset;
+  uint8_t start = 0;
+  uint8_t count = 0;
+  
+  for (sw = 0; sw < rows; sw++)
+  {
+    // Skip unchanged rows.
+    if (dirty[sw] == 0x0000)
+    {
+      continue;
+    }
+    // Row is in sync with shadow buffer after write, failed write marks its registers again.
+    mask = dirty[sw];
+    dirty[sw] = 0x0000;
+    for (cs = 0; cs < IS31FL3733_CS; cs++)
+    {
+      if (mask & (0x0001 << cs))
       {
-        // Clear bit for selected LED.
-        device->leds[offset] &= ~(0x01 << (cs % 8));
+        // Calculate LED offset.
+        offset = sw * IS31FL3733_CS + cs;
+        if (count != 0)
+        {
+          // Extend current burst over short gap of unchanged registers, it is cheaper than new transaction.
+          if (offset - (start + count) <= IS31FL3733_BURST_OVERHEAD)
+          {
+            count = offset - start + 1;
+            continue;
+          }
+          // Write current burst.
+          result = IS31FL3733_WritePagedRegs (device, reg_addr + start, &shadow[start], count);
+          if (status == 0)
+          {
+            status = result;
+          }
+        }
+        // Start new burst.
+        start = offset;
+        count = 1;
       }
-      else
+    }
+  }
+  // Write last burst.
+  if (count != 0)
+  {
+    result = IS31FL3733_WritePagedRegs (device, reg_addr + start, &shadow[start], count);
+    if (status == 0)
+    {
+      status = result;
+    }
+  }
+  return status;
+}
+
+uint8_t
+IS31FL3733_FlushRows (IS31FL3733 *device, uint8_t sw, uint8_t rows)
+{
+  uint8_t offset;
+  uint8_t status;
+  uint8_t result;
+  
+  // Calculate first row offset.
+  offset = sw * IS31FL3733_CS;
+  // Write changed PWM registers.
+  status = IS31FL3733_FlushRegs (device, IS31FL3733_LEDPWM + offset, &device->pwm[offset], &device->pwm_dirty[sw], rows);
+  // Write changed mode registers.
+  result = IS31FL3733_FlushRegs (device, IS31FL3733_LEDABM + offset, &device->modes[offset], &device->modes_dirty[sw], rows);
+  // Return first error.
+  return (status != 0) ? status : result;
+}
+
+uint8_t
+IS31FL3733_Flush (IS31FL3733 *device)
+{
+  // Write changed registers of all rows.
+  return IS31FL3733_FlushRows (device, 0, IS31FL3733_SW);
+}
+
+static uint8_t
+IS31FL3733_ResyncRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *shadow, uint32_t *stale, uint8_t size, uint8_t gap)
+{
+  uint32_t mask;
+  uint8_t status = 0;
+  uint8_t result;
+  uint8_t start = 0;
+  uint8_t count = 0;
+  uint8_t i;
+  
+  // Registers are in sync after write, failed write marks them again.
+  mask = *stale;
+  *stale = 0;
+  for (i = 0; i <= size; i++)
+  {
+    if ((i < size) && !(mask & ((uint32_t)1 << i)))
+    {
+      continue;
+    }
+    if (count != 0)
+    {
+      // Extend current burst over allowed gap of registers in sync.
+      if ((i < size) && (i - (start + count) <= gap))
       {
-        // Set bit for selected LED.
-        device->leds[offset] |= 0x01 << (cs % 8);
+        count = i - start + 1;
+        continue;
+      }
+      // Write current burst from shadow buffer.
+      result = IS31FL3733_WritePagedRegs (device, reg_addr + start, &shadow[start], count);
+      if (status == 0)
+      {
+        status = result;
       }
     }
+    // Start new burst.
+    start = i;
+    count = 1;
   }
-  // Write updated LEDs state to device registers.
-  IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDONOFF, device->leds, IS31FL3733_SW * IS31FL3733_CS / 8);
+  return status;
+}
+
+uint8_t
+IS31FL3733_Resync (IS31FL3733 *device)
+{
+  uint8_t status;
+  uint8_t result;
+  
+  // Write stale LED states.
+  status = IS31FL3733_ResyncRegs (device, IS31FL3733_LEDONOFF, device->leds, &device->leds_stale, sizeof(device->leds), IS31FL3733_BURST_OVERHEAD);
+  // Write stale PWM and mode registers, they are marked in dirty bitmasks.
+  result = IS31FL3733_Flush (device);
+  if (status == 0)
+  {
+    status = result;
+  }
+  // Write stale configuration last, registers in sync are skipped because TUR write restarts auto breath timing.
+  result = IS31FL3733_ResyncRegs (device, IS31FL3733_CR, device->config, &device->config_stale, IS31FL3733_CONFIG_SIZE, 0);
+  return (status != 0) ? status : result;
 }
 
 void
-IS31FL3733_SetPWM (IS31FL3733 *device, uint8_t *values)
+IS31FL3733_ComputeLoad (IS31FL3733 *device)
 {
-  // Write LED PWM values to device registers.
-  IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDPWM, values, IS31FL3733_SW * IS31FL3733_CS);
+  uint8_t i;
+  
+  // Sum PWM values of LEDs turned on.
+  device->load = 0;
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    if (device->leds[i / 8] & (0x01 << (i % 8)))
+    {
+      device->load += device->pwm[i];
+    }
+  }
+}
+
+uint8_t
+IS31FL3733_GetStatus (IS31FL3733 *device)
+{
+  uint8_t status = device->status;
+  
+  device->status = 0;
+  return status;
+}
+
+#ifdef IS31FL3733_USE_STATS
+void
+IS31FL3733_GetStats (IS31FL3733 *device, IS31FL3733_STATS *stats)
+{
+  *stats = device->stats;
+}
+
+void
+IS31FL3733_ResetStats (IS31FL3733 *device)
+{
+  memset (&device->stats, 0, sizeof(device->stats));
+}
+#endif
+
+void
+IS31FL3733_SetSyncMode (IS31FL3733 *device, IS31FL3733_SYNC_MODE mode)
+{
+  uint8_t cr;
+  
+  // Replace synchronization bits in configuration register.
+  cr = device->config[IS31FL3733_GET_ADDR(IS31FL3733_CR)];
+  cr &= ~(IS31FL3733_CR_SYNC_MASTER | IS31FL3733_CR_SYNC_SLAVE);
+  IS31FL3733_WritePagedReg (device, IS31FL3733_CR, cr | mode);
 }
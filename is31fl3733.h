@@ -62,6 +62,26 @@
 #define IS31FL3733_CSPDR (0x0310) /// CSx Pull-Down Resistor selection register. Write only.
 #define IS31FL3733_RESET (0x0311) /// Reset register. Read only.
 
+/// Active page is unknown and must be selected before next paged register access.
+#define IS31FL3733_PAGE_UNKNOWN (0xFF)
+
+/// Size of buffer for coalesced writes in batch mode, bytes.
+#ifndef IS31FL3733_BATCH_SIZE
+#define IS31FL3733_BATCH_SIZE (IS31FL3733_CS * 2)
+#endif
+
+/// Cost of starting new I2C write transaction in bytes: device address, register address and START/STOP conditions.
+/// Flush sends up to this number of unchanged registers between changed ones instead of starting new burst.
+#define IS31FL3733_BURST_OVERHEAD (3)
+
+/// Number of times failed I2C transfer is repeated before error is returned.
+#ifndef IS31FL3733_RETRIES
+#define IS31FL3733_RETRIES (2)
+#endif
+
+/// Number of writable Page 3 registers from CR to CSPDR.
+#define IS31FL3733_CONFIG_SIZE (IS31FL3733_GET_ADDR(IS31FL3733_CSPDR) + 1)
+
 /// Get register page.
 #define IS31FL3733_GET_PAGE(reg_addr) (uint8_t)((reg_addr) >> 8)
 /// Get register 8-bit address.
@@ -105,6 +125,32 @@ typedef enum {
   IS31FL3733_LED_STATUS_UNKNOWN = 0x03  ///< Unknown LED status.
 } IS31FL3733_LED_STATUS;
 
+/// Clock synchronization mode of multiple devices.
+typedef enum {
+  IS31FL3733_SYNC_MODE_NONE   = 0x00,                     ///< Clock synchronization disabled.
+  IS31FL3733_SYNC_MODE_MASTER = IS31FL3733_CR_SYNC_MASTER, ///< Device is clock master.
+  IS31FL3733_SYNC_MODE_SLAVE  = IS31FL3733_CR_SYNC_SLAVE   ///< Device is clock slave.
+} IS31FL3733_SYNC_MODE;
+
+/// Time to wait for open/short detection to complete, ms. Datasheet requires at least 3.264 ms.
+#define IS31FL3733_LED_SCAN_TIME (4)
+
+/// Open/short detection result for all LEDs.
+typedef struct {
+  /// Open LEDs, bitmask in LEDONOFF layout.
+  uint8_t open[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// Short LEDs, bitmask in LEDONOFF layout.
+  uint8_t shorted[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// Number of open LEDs.
+  uint8_t open_count;
+  /// Number of short LEDs.
+  uint8_t short_count;
+  /// Configuration register value restored after detection.
+  uint8_t cr;
+  /// Global current control value restored after detection.
+  uint8_t gcc;
+} IS31FL3733_LED_SCAN;
+
 /// Pull-Up or Pull-Down resistor value.
 typedef enum {
   IS31FL3733_RESISTOR_OFF = 0x00, ///< No resistor.
@@ -117,6 +163,47 @@ typedef enum {
   IS31FL3733_RESISTOR_32K = 0x07  ///< 32 kOhm pull-up resistor.
 } IS31FL3733_RESISTOR;
 
+/** Transport interface, used instead of blocking I2C functions when attached to device.
+    Embed it as first member of transport implementation structure to access implementation data.
+  */
+typedef struct IS31FL3733_TRANSPORT IS31FL3733_TRANSPORT;
+struct IS31FL3733_TRANSPORT {
+  /// Pointer to write registers function.
+  uint8_t (*write) (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+  /// Pointer to read registers function.
+  uint8_t (*read) (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+};
+
+#ifdef IS31FL3733_USE_STATS
+/// Number of latency histogram buckets. Bucket 0 counts calls shorter than 1 clock tick, bucket n counts calls of 2^(n-1) to 2^n-1 ticks, last bucket counts longer calls.
+#ifndef IS31FL3733_STATS_BUCKETS
+#define IS31FL3733_STATS_BUCKETS (16)
+#endif
+
+/** Device bus usage statistics.
+  */
+typedef struct {
+  /// Number of write and read transactions.
+  uint32_t transactions;
+  /// Number of transferred register values.
+  uint32_t bytes;
+  /// Number of page selects sent.
+  uint32_t page_switches;
+  /// Number of register writes skipped because shadow already had the same value.
+  uint32_t elided;
+  /// Number of transactions failed with non-zero status.
+  uint32_t errors;
+  /// Histogram of write and read function call durations.
+  uint32_t latency[IS31FL3733_STATS_BUCKETS];
+} IS31FL3733_STATS;
+
+/// Add value to device statistics counter.
+#define IS31FL3733_STATS_ADD(device, counter, value) ((device)->stats.counter += (value))
+#else
+/// Statistics are disabled, counters are not updated.
+#define IS31FL3733_STATS_ADD(device, counter, value) ((void)(value))
+#endif
+
 /** IS31FL3733 structure.
   */
 typedef struct {
@@ -124,43 +211,198 @@ typedef struct {
   uint8_t address;
   /// State of individual LED's. Bitmask, that can't be read back from IS31FL3733.
   uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// Active register page selected in PSR, IS31FL3733_PAGE_UNKNOWN if not known.
+  uint8_t page;
+  /// Batch mode flag: adjacent paged register writes are coalesced into one burst.
+  uint8_t batch;
+  /// Number of pending coalesced register values.
+  uint8_t batch_count;
+  /// Paged address of first pending coalesced register.
+  uint16_t batch_addr;
+  /// Pending coalesced register values.
+  uint8_t batch_buffer[IS31FL3733_BATCH_SIZE];
+  /// PWM duty of individual LED's. Shadow of Page 1 registers.
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  /// Operating mode of individual LED's. Shadow of Page 2 registers.
+  uint8_t modes[IS31FL3733_SW * IS31FL3733_CS];
+  /// PWM registers changed in shadow and not written to device yet. CS bitmask for each SW row.
+  uint16_t pwm_dirty[IS31FL3733_SW];
+  /// Mode registers changed in shadow and not written to device yet. CS bitmask for each SW row.
+  uint16_t modes_dirty[IS31FL3733_SW];
+  /// Correction table applied to PWM values, NULL for linear values.
+  const uint8_t *gamma;
+  /// Brightness scale applied to corrected PWM values, 255 for full brightness.
+  uint8_t brightness;
+  /// Values written to Page 3 registers from CR to CSPDR.
+  uint8_t config[IS31FL3733_CONFIG_SIZE];
+  /// Sum of PWM values of LED's turned on, updated with shadow buffers. Estimate of total LED current.
+  uint16_t load;
+  /// LEDONOFF registers, which may differ from shadow after failed write. Bitmask of register offsets.
+  uint32_t leds_stale;
+  /// Page 3 registers, which may differ from config after failed write. Bitmask of register offsets.
+  uint32_t config_stale;
+  /// First non-zero status returned by I2C functions or transport, cleared by IS31FL3733_GetStatus.
+  uint8_t status;
   /// Pointer to I2C write register function.
   uint8_t (*i2c_write_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
   /// Pointer to I2C read register function.
   uint8_t (*i2c_read_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+  /// Pointer to transport, NULL to use I2C functions above. Set with IS31FL3733_SetTransport.
+  IS31FL3733_TRANSPORT *transport;
+  /// Check value of transport written by IS31FL3733_SetTransport. Initialization drops transport without matching check value.
+  uintptr_t transport_check;
+#ifdef IS31FL3733_USE_STATS
+  /// Bus usage statistics.
+  IS31FL3733_STATS stats;
+  /// Optional pointer to function returning free running time in any units for latency histogram, e.g. microseconds. Set by application, NULL without clock.
+  uint32_t (*clock) (void);
+#endif
 } IS31FL3733;
 
+/// Magic number of valid snapshot, changed when snapshot layout changes.
+#define IS31FL3733_SNAPSHOT_MAGIC (0x4E533349)
+
+/** Persisted driver state for attach to running device without reset.
+  */
+typedef struct {
+  /// IS31FL3733_SNAPSHOT_MAGIC, if snapshot is complete.
+  uint32_t magic;
+  /// LED states, LEDONOFF registers.
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// PWM duty, Page 1 registers.
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  /// LED modes, Page 2 registers.
+  uint8_t modes[IS31FL3733_SW * IS31FL3733_CS];
+  /// Page 3 registers from CR to CSPDR.
+  uint8_t config[IS31FL3733_CONFIG_SIZE];
+  /// LEDOPEN registers read when snapshot was saved.
+  uint8_t open[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// LEDSHORT registers read when snapshot was saved.
+  uint8_t shorted[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// Checksum of snapshot contents from leds to shorted.
+  uint16_t checksum;
+} IS31FL3733_SNAPSHOT;
+
+/// Result of attach to running device.
+typedef enum {
+  IS31FL3733_ATTACH_OK         = 0x00, ///< Device state restored from snapshot.
+  IS31FL3733_ATTACH_INVALID    = 0x01, ///< Snapshot is incomplete or corrupted.
+  IS31FL3733_ATTACH_MISMATCH   = 0x02, ///< Device registers differ from snapshot, e.g. after power loss.
+  IS31FL3733_ATTACH_ERROR      = 0x03, ///< I2C transfer failed.
+  IS31FL3733_ATTACH_UNVERIFIED = 0x04 ///< Device state restored, but snapshot has no open or short LED, device can't be told apart from reset device.
+} IS31FL3733_ATTACH_RESULT;
+
 /// Read from common register.
 uint8_t IS31FL3733_ReadCommonReg (IS31FL3733 *device, uint8_t reg_addr);
-/// Write to common register.
-void IS31FL3733_WriteCommonReg (IS31FL3733 *device, uint8_t reg_addr, uint8_t reg_value);
-/// Select active page.
-void IS31FL3733_SelectPage (IS31FL3733 *device, uint8_t page);
+/// Read array from sequentially allocated common registers starting from specified address. Returns status of I2C function.
+uint8_t IS31FL3733_ReadCommonRegs (IS31FL3733 *device, uint8_t reg_addr, uint8_t *values, uint8_t count);
+/// Write to common register. Returns status of I2C function.
+uint8_t IS31FL3733_WriteCommonReg (IS31FL3733 *device, uint8_t reg_addr, uint8_t reg_value);
+/// Select active page. Returns status of I2C function, active page is unknown after failure.
+uint8_t IS31FL3733_SelectPage (IS31FL3733 *device, uint8_t page);
 /// Read from paged register.
 uint8_t IS31FL3733_ReadPagedReg (IS31FL3733 *device, uint16_t reg_addr);
-/// Write to paged register.
-void IS31FL3733_WritePagedReg (IS31FL3733 *device, uint16_t reg_addr, uint8_t reg_value);
-/// Write array to sequentially allocated paged registers starting from specified address.
-void IS31FL3733_WritePagedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t count);
+/// Read array from sequentially allocated paged registers starting from specified address. Returns status of I2C function.
+uint8_t IS31FL3733_ReadPagedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t count);
+/// Write to paged register. Returns status of I2C function.
+uint8_t IS31FL3733_WritePagedReg (IS31FL3733 *device, uint16_t reg_addr, uint8_t reg_value);
+/// Write array to sequentially allocated paged registers starting from specified address. Returns status of I2C function.
+/// Registers of failed write are marked stale and written again by IS31FL3733_Resync.
+uint8_t IS31FL3733_WritePagedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t count);
+/// Write every stride-th register from buffer starting at offset, in one burst over full span when it is cheaper. Returns first error.
+uint8_t IS31FL3733_WriteStridedRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *values, uint8_t offset, uint8_t stride, uint8_t count);
+/// Start coalescing adjacent paged register writes.
+void IS31FL3733_BeginBatch (IS31FL3733 *device);
+/// Write pending coalesced registers and stop coalescing. Returns status of I2C function.
+uint8_t IS31FL3733_EndBatch (IS31FL3733 *device);
+/// Attach transport to device, NULL to use I2C functions. Transport set before IS31FL3733_Init or IS31FL3733_Attach is kept by them,
+/// any other value of transport member is dropped, so device structure doesn't have to be zero-initialized.
+void IS31FL3733_SetTransport (IS31FL3733 *device, IS31FL3733_TRANSPORT *transport);
 /// Initialize IS31FL3733 for PWM operation.
 void IS31FL3733_Init (IS31FL3733 *device);
+/// Write stale registers and save driver state to snapshot for later attach. Returns status of I2C function, snapshot is invalid after failure.
+uint8_t IS31FL3733_SaveSnapshot (IS31FL3733 *device, IS31FL3733_SNAPSHOT *snapshot);
+/// Restore driver state from snapshot and verify running device instead of reset and initialization. Call IS31FL3733_Init if result is not OK.
+/// Device is verified with open/short registers, page 3 registers are write only and can't be verified. If snapshot has no open or short LED,
+/// state is restored and IS31FL3733_ATTACH_UNVERIFIED is returned: caller decides to trust snapshot or to call IS31FL3733_Init.
+IS31FL3733_ATTACH_RESULT IS31FL3733_Attach (IS31FL3733 *device, IS31FL3733_SNAPSHOT *snapshot);
 /// Set global current control register.
 void IS31FL3733_SetGCC (IS31FL3733 *device, uint8_t gcc);
 /// Set SW Pull-Up register.
 void IS31FL3733_SetSWPUR (IS31FL3733 *device, IS31FL3733_RESISTOR resistor);
 /// Set CS Pull-Down register.
 void IS31FL3733_SetCSPDR (IS31FL3733 *device, IS31FL3733_RESISTOR resistor);
+/// Set correction table for PWM values, e.g. from is31fl3733_gamma.h. NULL disables correction.
+void IS31FL3733_SetGamma (IS31FL3733 *device, const uint8_t *gamma);
+/// Set global brightness scale for PWM values.
+void IS31FL3733_SetBrightness (IS31FL3733 *device, uint8_t brightness);
+/// Apply correction table and brightness to PWM value.
+uint8_t IS31FL3733_CorrectPWM (IS31FL3733 *device, uint8_t value);
+/// Apply correction table and brightness to all LED's PWM values from src buffer and store them to dst buffer.
+void IS31FL3733_CorrectPWMBuffer (IS31FL3733 *device, uint8_t *dst, uint8_t *src);
+/// Store PWM value of LED at offset in shadow buffer and update load. Used by front ends writing registers themselves.
+void IS31FL3733_StorePWM (IS31FL3733 *device, uint8_t offset, uint8_t value);
+/// Store LEDONOFF register bits at offset in shadow buffer and update load. Used by front ends writing registers themselves.
+void IS31FL3733_StoreLEDs (IS31FL3733 *device, uint8_t offset, uint8_t bits);
 /// Set LED state: ON/OFF. Could be set ALL / CS / SW.
 void IS31FL3733_SetLEDState (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_STATE state);
 /// Set LED PWM duty value. Could be set ALL / CS / SW.
 void IS31FL3733_SetLEDPWM (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value);
 /// Get status of LED.
 IS31FL3733_LED_STATUS IS31FL3733_GetLEDStatus (IS31FL3733 *device, uint8_t cs, uint8_t sw);
+/// Turn on all LED's and start open/short detection.
+void IS31FL3733_StartLEDScan (IS31FL3733 *device, IS31FL3733_LED_SCAN *scan);
+/// Read open/short detection result for all LED's and restore LED states and configuration.
+void IS31FL3733_ReadLEDScan (IS31FL3733 *device, IS31FL3733_LED_SCAN *scan);
+/// Detect open/short LED's, waiting IS31FL3733_LED_SCAN_TIME with delay function.
+void IS31FL3733_ScanLEDs (IS31FL3733 *device, IS31FL3733_LED_SCAN *scan, void (*delay_ms) (uint32_t ms));
+/// Get status of LED from open/short detection result.
+IS31FL3733_LED_STATUS IS31FL3733_GetScanStatus (IS31FL3733_LED_SCAN *scan, uint8_t cs, uint8_t sw);
 /// Set LED state for all LED's from buffer.
 void IS31FL3733_SetState (IS31FL3733 *device, uint8_t *states);
+/// Set LED state for all LED's from buffer: LED is ON if value is greater than threshold. Only changed registers are written.
+void IS31FL3733_SetStateThreshold (IS31FL3733 *device, const uint8_t *values, uint8_t threshold);
+/// Set LED state for all LED's from 4 bits per LED buffer, high nibble first: LED is ON if value is greater than threshold.
+void IS31FL3733_SetStateThreshold4 (IS31FL3733 *device, const uint8_t *values, uint8_t threshold);
+/// Set LED state for all LED's from 1 bit per LED buffer in LEDONOFF layout. Only changed registers are written.
+void IS31FL3733_SetStatePacked (IS31FL3733 *device, const uint8_t *leds);
+/// Pack 8 bits per LED buffer to LEDONOFF layout: bit is set if value is greater than threshold.
+void IS31FL3733_PackState (uint8_t *leds, const uint8_t *values, uint8_t threshold);
+/// Pack 4 bits per LED buffer, high nibble first, to LEDONOFF layout: bit is set if value is greater than threshold.
+void IS31FL3733_PackState4 (uint8_t *leds, const uint8_t *values, uint8_t threshold);
 /// SET LED PWM duty value for all LED's from buffer.
 void IS31FL3733_SetPWM (IS31FL3733 *device, uint8_t *values);
-
-// TODO: add function to update region from {x0;y0} to {x1;y1}.
+/// Update registers shadow buffer and mark changed registers in dirty bitmask. Could be set ALL / CS / SW. Returns number of unchanged registers.
+uint8_t IS31FL3733_UpdateLEDRegs (uint8_t *shadow, uint16_t *dirty, uint8_t cs, uint8_t sw, uint8_t value);
+/// Write changed registers of specified number of rows from shadow buffer to device starting from specified address and clear dirty bitmask. Returns first error.
+uint8_t IS31FL3733_FlushRegs (IS31FL3733 *device, uint16_t reg_addr, uint8_t *shadow, uint16_t *dirty, uint8_t rows);
+/// Update LED PWM duty value in shadow buffer only. Could be set ALL / CS / SW.
+void IS31FL3733_UpdateLEDPWM (IS31FL3733 *device, uint8_t cs, uint8_t sw, uint8_t value);
+/// Update LED PWM duty value for all LED's from buffer in shadow buffer only.
+void IS31FL3733_UpdatePWM (IS31FL3733 *device, uint8_t *values);
+/// Update LED PWM duty value for all LED's from buffer in shadow buffer only, without correction table and brightness.
+void IS31FL3733_UpdateRawPWM (IS31FL3733 *device, const uint8_t *values);
+/// Write changed PWM and mode registers from shadow buffers to device with minimal number of bursts. Returns first error.
+uint8_t IS31FL3733_Flush (IS31FL3733 *device);
+/// Write changed PWM and mode registers of specified rows starting from SW row. Returns first error.
+uint8_t IS31FL3733_FlushRows (IS31FL3733 *device, uint8_t sw, uint8_t rows);
+/// Mark registers, which may have old values in device after failed write, e.g. by asynchronous transport. They are written by IS31FL3733_Resync.
+void IS31FL3733_MarkStale (IS31FL3733 *device, uint16_t reg_addr, uint8_t count);
+/// Write registers left stale by failed writes from shadow buffers, without reset and full redraw. Returns first error.
+uint8_t IS31FL3733_Resync (IS31FL3733 *device);
+/// Sum load again from shadow buffers, after they were changed directly.
+void IS31FL3733_ComputeLoad (IS31FL3733 *device);
+/// Keep status of transfer until it is read with IS31FL3733_GetStatus, if it is the first error. Used by transports sending writes later.
+void IS31FL3733_KeepStatus (IS31FL3733 *device, uint8_t status);
+/// Get and clear first error status of device I2C transfers, including functions without status result.
+uint8_t IS31FL3733_GetStatus (IS31FL3733 *device);
+#ifdef IS31FL3733_USE_STATS
+/// Copy device bus usage statistics.
+void IS31FL3733_GetStats (IS31FL3733 *device, IS31FL3733_STATS *stats);
+/// Clear device bus usage statistics.
+void IS31FL3733_ResetStats (IS31FL3733 *device);
+#endif
+/// Set clock synchronization mode.
+void IS31FL3733_SetSyncMode (IS31FL3733 *device, IS31FL3733_SYNC_MODE mode);
 
 #endif /* _IS31FL3733_H_ */
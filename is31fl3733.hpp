@@ -0,0 +1,285 @@
+/** ISSI IS31FL3733 header-only C++ front end.
+  * Device wraps IS31FL3733 structure of C driver and is parameterised on I2C address, bus type and panel size:
+  * LED coordinates, ALL / CS / SW selection, register offsets and pages are resolved at compile time, while
+  * shadow buffers, load, page cache, batch mode, retries, stale registers and statistics are kept by C driver.
+  * C driver calls bus through transport of device, so each transfer stays an indirect call through transport
+  * function pointer: only Bus::write and Bus::read are inlined into transport functions, not into driver paths.
+  * Wire traffic is the same as of C functions.
+  */
+#ifndef _IS31FL3733_HPP_
+#define _IS31FL3733_HPP_
+
+// Compile time selection of LED, row and column writes uses if constexpr.
+#if __cplusplus < 201703L
+#error "is31fl3733.hpp requires C++17"
+#endif
+
+#include <string.h>
+
+extern "C" {
+#include "is31fl3733.h"
+#include "is31fl3733_abm.h"
+}
+
+/** Bus binding of blocking I2C functions known at compile time.
+  */
+template <uint8_t (*I2CWriteReg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count),
+          uint8_t (*I2CReadReg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)>
+struct IS31FL3733_I2C {
+  /// Write registers.
+  uint8_t write (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+  {
+    return I2CWriteReg (i2c_addr, reg_addr, buffer, count);
+  }
+  /// Read registers.
+  uint8_t read (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+  {
+    return I2CReadReg (i2c_addr, reg_addr, buffer, count);
+  }
+};
+
+/** IS31FL3733 device.
+  * Address is I2C address, e.g. IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND). Bus is any type with
+  * write and read member functions taking the same arguments as I2C functions of C driver.
+  * LED's outside of Width CS lines and Height SW lines are rejected at compile time.
+  * IS31FL3733_CS and IS31FL3733_SW select all CS and SW lines.
+  * Device() is C driver structure for C modules, e.g. display, gfx, mailbox, scheduler and limiter.
+  * Device is not copied, C driver and modules keep pointers to it.
+  */
+template <uint8_t Address, class Bus, uint8_t Width = IS31FL3733_CS, uint8_t Height = IS31FL3733_SW>
+class IS31FL3733_Device {
+  static_assert ((Width <= IS31FL3733_CS) && (Height <= IS31FL3733_SW), "Panel doesn't fit into LED matrix");
+
+public:
+  /// Bind device to bus.
+  explicit IS31FL3733_Device (Bus &bus) : port_ {{&BusWrite, &BusRead}, &bus}, device_ {}
+  {
+    // C driver writes through bus port.
+    device_.address = Address;
+    IS31FL3733_SetTransport (&device_, &port_.transport);
+  }
+
+  IS31FL3733_Device (const IS31FL3733_Device &) = delete;
+  IS31FL3733_Device &operator= (const IS31FL3733_Device &) = delete;
+
+  /// C driver structure of device.
+  IS31FL3733 *Device ()
+  {
+    return &device_;
+  }
+
+  /// Initialize IS31FL3733 for PWM operation.
+  void Init ()
+  {
+    IS31FL3733_Init (&device_);
+  }
+
+  /// Set global current control register. Returns status of I2C function.
+  uint8_t SetGCC (uint8_t gcc)
+  {
+    return IS31FL3733_WritePagedReg (&device_, IS31FL3733_GCC, gcc);
+  }
+
+  /// Set correction table for PWM values, e.g. from is31fl3733_gamma.h. NULL disables correction.
+  void SetGamma (const uint8_t *gamma)
+  {
+    IS31FL3733_SetGamma (&device_, gamma);
+  }
+
+  /// Set global brightness scale for PWM values.
+  void SetBrightness (uint8_t brightness)
+  {
+    IS31FL3733_SetBrightness (&device_, brightness);
+  }
+
+  /// Set LED state: ON/OFF. Could be set ALL / CS / SW. Returns first error.
+  template <uint8_t CS, uint8_t SW>
+  uint8_t SetLEDState (IS31FL3733_LED_STATE state)
+  {
+    CheckLED<CS, SW> ();
+    if constexpr ((SW < IS31FL3733_SW) && (CS < IS31FL3733_CS))
+    {
+      // Set state of individual LED.
+      constexpr uint8_t offset = (SW << 1) + (CS / 8);
+      StoreLEDBit<CS> (offset, state);
+      return IS31FL3733_WritePagedReg (&device_, IS31FL3733_LEDONOFF + offset, device_.leds[offset]);
+    }
+    else if constexpr (SW < IS31FL3733_SW)
+    {
+      // Set state of full row selected by SW.
+      constexpr uint8_t offset = SW << 1;
+      IS31FL3733_StoreLEDs (&device_, offset, (state == IS31FL3733_LED_STATE_OFF) ? 0x00 : 0xFF);
+      IS31FL3733_StoreLEDs (&device_, offset + 1, (state == IS31FL3733_LED_STATE_OFF) ? 0x00 : 0xFF);
+      return IS31FL3733_WritePagedRegs (&device_, IS31FL3733_LEDONOFF + offset, &device_.leds[offset], IS31FL3733_CS / 8);
+    }
+    else if constexpr (CS < IS31FL3733_CS)
+    {
+      // Set state of full column selected by CS.
+      for (uint8_t sw = 0; sw < IS31FL3733_SW; sw++)
+      {
+        StoreLEDBit<CS> ((sw << 1) + (CS / 8), state);
+      }
+      return IS31FL3733_WriteStridedRegs (&device_, IS31FL3733_LEDONOFF, device_.leds, CS / 8, IS31FL3733_CS / 8, IS31FL3733_SW);
+    }
+    else
+    {
+      // Set state of all LEDs.
+      for (uint8_t offset = 0; offset < sizeof(device_.leds); offset++)
+      {
+        IS31FL3733_StoreLEDs (&device_, offset, (state == IS31FL3733_LED_STATE_OFF) ? 0x00 : 0xFF);
+      }
+      return IS31FL3733_WritePagedRegs (&device_, IS31FL3733_LEDONOFF, device_.leds, sizeof(device_.leds));
+    }
+  }
+
+  /// Set LED PWM duty value with correction table and brightness. Could be set ALL / CS / SW. Returns first error.
+  template <uint8_t CS, uint8_t SW>
+  uint8_t SetLEDPWM (uint8_t value)
+  {
+    CheckLED<CS, SW> ();
+    value = IS31FL3733_CorrectPWM (&device_, value);
+    if constexpr ((SW < IS31FL3733_SW) && (CS < IS31FL3733_CS))
+    {
+      // Set PWM of individual LED.
+      constexpr uint8_t offset = SW * IS31FL3733_CS + CS;
+      IS31FL3733_StorePWM (&device_, offset, value);
+      device_.pwm_dirty[SW] &= ~(0x0001 << CS);
+      return IS31FL3733_WritePagedReg (&device_, IS31FL3733_LEDPWM + offset, value);
+    }
+    else if constexpr (SW < IS31FL3733_SW)
+    {
+      // Set PWM of full row selected by SW in one burst.
+      constexpr uint8_t offset = SW * IS31FL3733_CS;
+      for (uint8_t cs = 0; cs < IS31FL3733_CS; cs++)
+      {
+        IS31FL3733_StorePWM (&device_, offset + cs, value);
+      }
+      device_.pwm_dirty[SW] = 0x0000;
+      return IS31FL3733_WritePagedRegs (&device_, IS31FL3733_LEDPWM + offset, &device_.pwm[offset], IS31FL3733_CS);
+    }
+    else if constexpr (CS < IS31FL3733_CS)
+    {
+      // Set PWM of full column selected by CS.
+      for (uint8_t sw = 0; sw < IS31FL3733_SW; sw++)
+      {
+        IS31FL3733_StorePWM (&device_, sw * IS31FL3733_CS + CS, value);
+        device_.pwm_dirty[sw] &= ~(0x0001 << CS);
+      }
+      return IS31FL3733_WriteStridedRegs (&device_, IS31FL3733_LEDPWM, device_.pwm, CS, IS31FL3733_CS, IS31FL3733_SW);
+    }
+    else
+    {
+      // Set PWM of all LEDs in one burst, load of all LEDs turned on is replaced.
+      memset (device_.pwm, value, sizeof(device_.pwm));
+      memset (device_.pwm_dirty, 0, sizeof(device_.pwm_dirty));
+      IS31FL3733_ComputeLoad (&device_);
+      return IS31FL3733_WritePagedRegs (&device_, IS31FL3733_LEDPWM, device_.pwm, sizeof(device_.pwm));
+    }
+  }
+
+  /// Set LED mode: PWM or one of ABM. Could be set ALL / CS / SW.
+  template <uint8_t CS, uint8_t SW>
+  void SetLEDMode (IS31FL3733_LED_MODE mode)
+  {
+    CheckLED<CS, SW> ();
+    IS31FL3733_SetLEDMode (&device_, CS, SW, mode);
+  }
+
+  /// Set LED PWM duty value for all LED's from buffer.
+  void SetPWM (const uint8_t *values)
+  {
+    // C driver reads values only.
+    IS31FL3733_SetPWM (&device_, const_cast<uint8_t *> (values));
+  }
+
+  /// Update LED PWM duty value in shadow buffer only. Could be set ALL / CS / SW.
+  template <uint8_t CS, uint8_t SW>
+  void UpdateLEDPWM (uint8_t value)
+  {
+    CheckLED<CS, SW> ();
+    IS31FL3733_UpdateLEDPWM (&device_, CS, SW, value);
+  }
+
+  /// Update LED PWM duty value for all LED's from buffer in shadow buffer only.
+  void UpdatePWM (const uint8_t *values)
+  {
+    IS31FL3733_UpdatePWM (&device_, const_cast<uint8_t *> (values));
+  }
+
+  /// Write changed PWM and mode registers from shadow buffers to device with minimal number of bursts. Returns first error.
+  uint8_t Flush ()
+  {
+    return IS31FL3733_Flush (&device_);
+  }
+
+  /// Set LED state for all LED's from 1 bit per LED buffer in LEDONOFF layout. Only changed registers are written.
+  void SetStatePacked (const uint8_t *leds)
+  {
+    IS31FL3733_SetStatePacked (&device_, leds);
+  }
+
+  /// Start coalescing adjacent paged register writes.
+  void BeginBatch ()
+  {
+    IS31FL3733_BeginBatch (&device_);
+  }
+
+  /// Write pending coalesced registers and stop coalescing. Returns status of I2C function.
+  uint8_t EndBatch ()
+  {
+    return IS31FL3733_EndBatch (&device_);
+  }
+
+  /// Write registers left stale by failed writes from shadow buffers. Returns first error.
+  uint8_t Resync ()
+  {
+    return IS31FL3733_Resync (&device_);
+  }
+
+  /// Get and clear first error status of I2C transfers.
+  uint8_t GetStatus ()
+  {
+    return IS31FL3733_GetStatus (&device_);
+  }
+
+private:
+  /// Transport of C driver calling bus. Transport is the first member, so port is found from transport pointer.
+  struct Port {
+    IS31FL3733_TRANSPORT transport;
+    Bus *bus;
+  };
+
+  static uint8_t BusWrite (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+  {
+    return reinterpret_cast<Port *> (transport)->bus->write (i2c_addr, reg_addr, buffer, count);
+  }
+
+  static uint8_t BusRead (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+  {
+    return reinterpret_cast<Port *> (transport)->bus->read (i2c_addr, reg_addr, buffer, count);
+  }
+
+  /// Reject LED's outside of panel.
+  template <uint8_t CS, uint8_t SW>
+  static constexpr void CheckLED ()
+  {
+    static_assert ((CS < Width) || (CS == IS31FL3733_CS), "CS line is outside of panel");
+    static_assert ((SW < Height) || (SW == IS31FL3733_SW), "SW line is outside of panel");
+  }
+
+  /// Set or clear bit of LED in LEDONOFF register shadow.
+  template <uint8_t CS>
+  void StoreLEDBit (uint8_t offset, IS31FL3733_LED_STATE state)
+  {
+    constexpr uint8_t bit = 0x01 << (CS % 8);
+    
+    IS31FL3733_StoreLEDs (&device_, offset, (state == IS31FL3733_LED_STATE_OFF) ? device_.leds[offset] & ~bit : device_.leds[offset] | bit);
+  }
+
+  /// Bus port used as transport of device.
+  Port port_;
+  /// C driver state.
+  IS31FL3733 device_;
+};
+
+#endif /* _IS31FL3733_HPP_ */
@@ -1,5 +1,7 @@
 #include "is31fl3733_abm.h"
 
+#include <string.h>
+
 void
 IS31FL3733_SetLEDMode (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_MODE mode)
 {
@@ -14,19 +16,22 @@ IS31FL3733_SetLEDMode (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LE
       // Set mode of individual LED.
       // Calculate LED offset.
       offset = sw * IS31FL3733_CS + cs;
+      // Update LED mode in shadow buffer.
+      device->modes[offset] = mode;
+      device->modes_dirty[sw] &= ~(0x0001 << cs);
       // Write LED mode to device register.
       IS31FL3733_WritePagedReg (device, IS31FL3733_LEDABM + offset, mode);
     }
     else
     {
       // Set mode of full row selected by SW.
-      for (cs = 0; cs < IS31FL3733_CS; cs++)
-      {
-        // Calculate LED offset.
-        offset = sw * IS31FL3733_CS + cs;
-        // Write LED mode to device register.
-        IS31FL3733_WritePagedReg (device, IS31FL3733_LEDABM + offset, mode);
-      }
+      // Calculate row offset.
+      offset = sw * IS31FL3733_CS;
+      // Update row LED modes in shadow buffer.
+      memset (&device->modes[offset], mode, IS31FL3733_CS);
+      device->modes_dirty[sw] = 0x0000;
+      // Write row LED modes to device registers in one burst.
+      IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDABM + offset, &device->modes[offset], IS31FL3733_CS);
     }
   }
   else
@@ -37,49 +42,163 @@ IS31FL3733_SetLEDMode (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LE
       // Set mode of full column selected by CS.
       for (sw = 0; sw < IS31FL3733_SW; sw++)
       {
-          // Calculate LED offset.
-          offset = sw * IS31FL3733_CS + cs;
-          // Write LED mode to device register.
-          IS31FL3733_WritePagedReg (device, IS31FL3733_LEDABM + offset, mode);
+        // Update LED mode in shadow buffer.
+        device->modes[sw * IS31FL3733_CS + cs] = mode;
+        device->modes_dirty[sw] &= ~(0x0001 << cs);
       }
+      // Write column LED modes to device registers.
+      IS31FL3733_WriteStridedRegs (device, IS31FL3733_LEDABM, device->modes, cs, IS31FL3733_CS, IS31FL3733_SW);
     }
     else
     {
       // Set mode of all LEDs.
-      for (sw = 0; sw < IS31FL3733_SW; sw++)
-      {
-        for (cs = 0; cs < IS31FL3733_CS; cs++)
-        {
-          // Calculate LED offset.
-          offset = sw * IS31FL3733_CS + cs;
-          // Write LED mode to device register.
-          IS31FL3733_WritePagedReg (device, IS31FL3733_LEDABM + offset, mode);
-        }
-      }
+      // Update LED modes in shadow buffer.
+      memset (device->modes, mode, sizeof(device->modes));
+      memset (device->modes_dirty, 0, sizeof(device->modes_dirty));
+      // Write LED modes to device registers in one burst.
+      IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDABM, device->modes, IS31FL3733_SW * IS31FL3733_CS);
     }
   }
 }
 
+void
+IS31FL3733_UpdateLEDMode (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_MODE mode)
+{
+  uint8_t unchanged;
+  
+  // Update LED mode in shadow buffer.
+  unchanged = IS31FL3733_UpdateLEDRegs (device->modes, device->modes_dirty, cs, sw, mode);
+  IS31FL3733_STATS_ADD (device, elided, unchanged);
+}
+
+static void
+IS31FL3733_EncodeABM (const IS31FL3733_ABM *config, uint8_t *values)
+{
+  // Fade in and fade out time.
+  values[0] = config->T1 | config->T2;
+  // Hold and off time.
+  values[1] = config->T3 | config->T4;
+  // Loop begin/end time and high part of loop times.
+  values[2] = config->Tend | config->Tbegin | ((config->Times >> 8) & 0x0F);
+  // Low part of loop times.
+  values[3] = config->Times & 0xFF;
+}
+
 void
 IS31FL3733_ConfigABM (IS31FL3733 *device, IS31FL3733_ABM_NUM n, IS31FL3733_ABM *config)
 {
-  // Set fade in and fade out time.
-  IS31FL3733_WritePagedReg (device, n, config->T1 | config->T2);
-  // Set hold and off time.
-  IS31FL3733_WritePagedReg (device, n + 1, config->T3 | config->T4);
-  // Set loop begin/end time and high part of loop times.
-  IS31FL3733_WritePagedReg (device, n + 2, config->Tend | config->Tbegin | ((config->Times >> 8) & 0x0F));
-  // Set low part of loop times.
-  IS31FL3733_WritePagedReg (device, n + 3, config->Times & 0xFF);
+  uint8_t values[4];
+  
+  // Write all ABM registers in one burst.
+  IS31FL3733_EncodeABM (config, values);
+  IS31FL3733_WritePagedRegs (device, n, values, sizeof(values));
 }
 
 void
 IS31FL3733_StartABM (IS31FL3733 *device)
 {
+  uint8_t cr;
+  
+  // Keep synchronization bits of configuration register.
+  cr = device->config[IS31FL3733_GET_ADDR(IS31FL3733_CR)] & (IS31FL3733_CR_SYNC_MASTER | IS31FL3733_CR_SYNC_SLAVE);
   // Clear B_EN bit in configuration register.
-  IS31FL3733_WritePagedReg (device, IS31FL3733_CR, IS31FL3733_CR_SSD);
+  IS31FL3733_WritePagedReg (device, IS31FL3733_CR, cr | IS31FL3733_CR_SSD);
   // Set B_EN bit in configuration register.
-  IS31FL3733_WritePagedReg (device, IS31FL3733_CR, IS31FL3733_CR_BEN | IS31FL3733_CR_SSD);
+  IS31FL3733_WritePagedReg (device, IS31FL3733_CR, cr | IS31FL3733_CR_BEN | IS31FL3733_CR_SSD);
   // Write 0x00 to Time Update Register to update ABM settings.
   IS31FL3733_WritePagedReg (device, IS31FL3733_TUR, 0x00);
 }
+
+static uint8_t
+IS31FL3733_EqualABM (const IS31FL3733_ABM *a, const IS31FL3733_ABM *b)
+{
+  return (a->T1 == b->T1) && (a->T2 == b->T2) && (a->T3 == b->T3) && (a->T4 == b->T4) &&
+         (a->Tbegin == b->Tbegin) && (a->Tend == b->Tend) && (a->Times == b->Times);
+}
+
+void
+IS31FL3733_ABMManager_Init (IS31FL3733_ABM_MANAGER *manager, IS31FL3733 *device)
+{
+  manager->device = device;
+  memset (manager->configs, 0, sizeof(manager->configs));
+  memset (manager->refs, 0, sizeof(manager->refs));
+}
+
+IS31FL3733_LED_MODE
+IS31FL3733_ABMManager_Request (IS31FL3733_ABM_MANAGER *manager, const IS31FL3733_ABM *config)
+{
+  uint8_t free = IS31FL3733_ABM_SLOTS;
+  uint8_t i;
+  
+  for (i = 0; i < IS31FL3733_ABM_SLOTS; i++)
+  {
+    // Share ABM function with equal configuration.
+    if ((manager->refs[i] != 0) && IS31FL3733_EqualABM (&manager->configs[i], config))
+    {
+      manager->refs[i]++;
+      return (IS31FL3733_LED_MODE)(IS31FL3733_LED_MODE_ABM1 + i);
+    }
+    if ((manager->refs[i] == 0) && (free == IS31FL3733_ABM_SLOTS))
+    {
+      free = i;
+    }
+  }
+  // All ABM functions are in use.
+  if (free == IS31FL3733_ABM_SLOTS)
+  {
+    return IS31FL3733_LED_MODE_PWM;
+  }
+  manager->configs[free] = *config;
+  manager->refs[free] = 1;
+  return (IS31FL3733_LED_MODE)(IS31FL3733_LED_MODE_ABM1 + free);
+}
+
+void
+IS31FL3733_ABMManager_Release (IS31FL3733_ABM_MANAGER *manager, IS31FL3733_LED_MODE mode)
+{
+  uint8_t i;
+  
+  // PWM mode and invalid modes don't hold ABM function.
+  if ((mode < IS31FL3733_LED_MODE_ABM1) || (mode > IS31FL3733_LED_MODE_ABM3))
+  {
+    return;
+  }
+  // Extra release of free function is ignored.
+  i = mode - IS31FL3733_LED_MODE_ABM1;
+  if (manager->refs[i] != 0)
+  {
+    manager->refs[i]--;
+  }
+}
+
+void
+IS31FL3733_ABMManager_Apply (IS31FL3733_ABM_MANAGER *manager)
+{
+  IS31FL3733 *device = manager->device;
+  uint8_t values[IS31FL3733_GET_ADDR(IS31FL3733_TUR) + 1];
+  uint8_t first;
+  uint8_t i;
+  
+  // Build Page 3 registers from CR to TUR starting from shadow.
+  memcpy (values, device->config, sizeof(values));
+  values[IS31FL3733_GET_ADDR(IS31FL3733_CR)] |= IS31FL3733_CR_BEN | IS31FL3733_CR_SSD;
+  for (i = 0; i < IS31FL3733_ABM_SLOTS; i++)
+  {
+    // Unused functions keep their registers.
+    if (manager->refs[i] != 0)
+    {
+      IS31FL3733_EncodeABM (&manager->configs[i], &values[IS31FL3733_GET_ADDR(IS31FL3733_ABM1) + i * 4]);
+    }
+  }
+  values[IS31FL3733_GET_ADDR(IS31FL3733_TUR)] = 0x00;
+  // Find first changed register, TUR is always written to update ABM times.
+  for (first = 0; first < IS31FL3733_GET_ADDR(IS31FL3733_TUR); first++)
+  {
+    if (values[first] != device->config[first])
+    {
+      break;
+    }
+  }
+  IS31FL3733_STATS_ADD (device, elided, first);
+  IS31FL3733_WritePagedRegs (device, IS31FL3733_CR + first, &values[first], sizeof(values) - first);
+}
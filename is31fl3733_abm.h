@@ -119,11 +119,35 @@ typedef struct {
   uint16_t Times;
 } IS31FL3733_ABM;
 
+/// Number of ABM functions.
+#define IS31FL3733_ABM_SLOTS (3)
+
+/** ABM program manager: shares ABM functions between requested configurations.
+  */
+typedef struct {
+  /// Pointer to device.
+  IS31FL3733 *device;
+  /// ABM function configurations.
+  IS31FL3733_ABM configs[IS31FL3733_ABM_SLOTS];
+  /// Number of requests using each ABM function, 0 - function is free.
+  uint8_t refs[IS31FL3733_ABM_SLOTS];
+} IS31FL3733_ABM_MANAGER;
+
 /// Set LED operating mode: PWM/ABM1,2,3. Could be set ALL / CS / SW.
 void IS31FL3733_SetLEDMode (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_MODE mode);
+/// Update LED operating mode in shadow buffer only, use IS31FL3733_Flush to write it. Could be set ALL / CS / SW.
+void IS31FL3733_UpdateLEDMode (IS31FL3733 *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_MODE mode);
 /// Configure ABM Mode.
 void IS31FL3733_ConfigABM (IS31FL3733 *device, IS31FL3733_ABM_NUM n, IS31FL3733_ABM *config);
 /// Start ABM operation.
 void IS31FL3733_StartABM (IS31FL3733 *device);
+/// Initialize ABM manager with all ABM functions free.
+void IS31FL3733_ABMManager_Init (IS31FL3733_ABM_MANAGER *manager, IS31FL3733 *device);
+/// Request ABM function with configuration, equal configurations share function. Returns LED mode, IS31FL3733_LED_MODE_PWM if all functions are in use.
+IS31FL3733_LED_MODE IS31FL3733_ABMManager_Request (IS31FL3733_ABM_MANAGER *manager, const IS31FL3733_ABM *config);
+/// Release ABM function returned by IS31FL3733_ABMManager_Request. PWM mode, invalid modes and releases of free functions are ignored.
+void IS31FL3733_ABMManager_Release (IS31FL3733_ABM_MANAGER *manager, IS31FL3733_LED_MODE mode);
+/// Write changed ABM registers, enable ABM and update times in one burst.
+void IS31FL3733_ABMManager_Apply (IS31FL3733_ABM_MANAGER *manager);
 
 #endif /* _IS31FL3733_ABM_H_ */
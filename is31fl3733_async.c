@@ -0,0 +1,357 @@
+#include "is31fl3733_async.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static void
+IS31FL3733_Queue_Lock (IS31FL3733_QUEUE *queue)
+{
+  if (queue->lock != NULL)
+  {
+    queue->lock (queue);
+  }
+}
+
+static void
+IS31FL3733_Queue_Unlock (IS31FL3733_QUEUE *queue)
+{
+  if (queue->unlock != NULL)
+  {
+    queue->unlock (queue);
+  }
+}
+
+static void
+IS31FL3733_Queue_Wait (IS31FL3733_QUEUE *queue)
+{
+  if (queue->wait != NULL)
+  {
+    queue->wait (queue);
+  }
+}
+
+static void
+IS31FL3733_Queue_Fail (IS31FL3733_QUEUE *queue, uint8_t page, uint8_t reg_addr, uint8_t count)
+{
+  // Extend range of registers written by failed transactions in page.
+  if (!(queue->failed & (1 << page)))
+  {
+    queue->failed_first[page] = reg_addr;
+    queue->failed_end[page] = reg_addr + count;
+  }
+  else
+  {
+    if (reg_addr < queue->failed_first[page])
+    {
+      queue->failed_first[page] = reg_addr;
+    }
+    if (reg_addr + count > queue->failed_end[page])
+    {
+      queue->failed_end[page] = reg_addr + count;
+    }
+  }
+  queue->failed |= (1 << page) | (1 << IS31FL3733_QUEUE_PAGES);
+}
+
+static void
+IS31FL3733_Queue_Complete (IS31FL3733_QUEUE *queue, IS31FL3733_TRANSACTION *item, uint8_t status)
+{
+  uint8_t page;
+  
+  // Any failure makes active page unknown to driver.
+  if (status != 0)
+  {
+    queue->failed |= 1 << IS31FL3733_QUEUE_PAGES;
+  }
+  if (item->reg_addr == IS31FL3733_PSWL)
+  {
+    queue->unlocked = (status == 0);
+    return;
+  }
+  if (item->reg_addr == IS31FL3733_PSR)
+  {
+    // Device keeps previous page, if page select failed or wasn't unlocked.
+    if ((status == 0) && queue->unlocked)
+    {
+      queue->bus_page = item->page;
+      queue->misrouted = 0;
+    }
+    else
+    {
+      queue->misrouted = 1;
+    }
+    queue->unlocked = 0;
+    return;
+  }
+  // Common registers are not tracked.
+  if (item->page >= IS31FL3733_QUEUE_PAGES)
+  {
+    return;
+  }
+  // Registers keep old values after failed write or write to other page.
+  if ((status != 0) || queue->misrouted)
+  {
+    IS31FL3733_Queue_Fail (queue, item->page, item->reg_addr, item->count);
+  }
+  // Write to other page changes its registers, any page if it is unknown.
+  if ((status == 0) && queue->misrouted)
+  {
+    for (page = 0; page < IS31FL3733_QUEUE_PAGES; page++)
+    {
+      if ((queue->bus_page == page) || (queue->bus_page == IS31FL3733_PAGE_UNKNOWN))
+      {
+        IS31FL3733_Queue_Fail (queue, page, item->reg_addr, item->count);
+      }
+    }
+  }
+}
+
+static void
+IS31FL3733_Queue_MarkStale (IS31FL3733_QUEUE *queue)
+{
+  uint8_t first[IS31FL3733_QUEUE_PAGES];
+  uint16_t end[IS31FL3733_QUEUE_PAGES];
+  uint8_t failed;
+  uint8_t page;
+  
+  if (queue->failed == 0)
+  {
+    return;
+  }
+  // Take failures reported since last call.
+  IS31FL3733_Queue_Lock (queue);
+  failed = queue->failed;
+  for (page = 0; page < IS31FL3733_QUEUE_PAGES; page++)
+  {
+    first[page] = queue->failed_first[page];
+    end[page] = queue->failed_end[page];
+  }
+  queue->failed = 0;
+  IS31FL3733_Queue_Unlock (queue);
+  // Driver selects page again before next paged register access.
+  queue->device->page = IS31FL3733_PAGE_UNKNOWN;
+  // Registers are written again by IS31FL3733_Resync.
+  for (page = 0; page < IS31FL3733_QUEUE_PAGES; page++)
+  {
+    if (failed & (1 << page))
+    {
+      IS31FL3733_MarkStale (queue->device, ((uint16_t)page << 8) | first[page], (uint8_t)(end[page] - first[page]));
+    }
+  }
+}
+
+static void
+IS31FL3733_Queue_Kick (IS31FL3733_QUEUE *queue)
+{
+  IS31FL3733_TRANSACTION *item;
+  uint8_t status;
+  
+  IS31FL3733_Queue_Lock (queue);
+  // Check if transfer is in progress or queue is empty.
+  if (queue->busy || (queue->head == queue->tail))
+  {
+    IS31FL3733_Queue_Unlock (queue);
+    return;
+  }
+  // Take oldest transaction.
+  queue->busy = 1;
+  item = &queue->items[queue->tail & (IS31FL3733_QUEUE_LENGTH - 1)];
+  IS31FL3733_Queue_Unlock (queue);
+  // Submit transaction to transport.
+  status = queue->i2c_submit (queue, item->i2c_addr, item->reg_addr, &queue->data[item->offset], item->count);
+  // Transaction is rejected, complete it with error.
+  if (status != 0)
+  {
+    IS31FL3733_Queue_Notify (queue, status);
+  }
+}
+
+static uint8_t
+IS31FL3733_Queue_Write (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  IS31FL3733_QUEUE *queue = (IS31FL3733_QUEUE *)transport;
+  IS31FL3733_TRANSACTION *item;
+  uint16_t offset;
+  uint16_t size;
+  
+  // Apply failures of completed transactions before registers are written again.
+  IS31FL3733_Queue_MarkStale (queue);
+  // Payload of transaction must be contiguous, skip buffer tail if payload doesn't fit into it.
+  offset = queue->data_head & (IS31FL3733_QUEUE_DATA_SIZE - 1);
+  size = count;
+  if (offset + count > IS31FL3733_QUEUE_DATA_SIZE)
+  {
+    size += IS31FL3733_QUEUE_DATA_SIZE - offset;
+    offset = 0;
+  }
+  // Wait for free transaction slot and payload space.
+  while (((uint8_t)(queue->head - queue->tail) >= IS31FL3733_QUEUE_LENGTH) ||
+         ((uint16_t)(queue->data_head - queue->data_tail) + size > IS31FL3733_QUEUE_DATA_SIZE))
+  {
+    IS31FL3733_Queue_Wait (queue);
+  }
+  // Copy payload, so caller could reuse buffer immediately.
+  memcpy (&queue->data[offset], buffer, count);
+  // Fill transaction.
+  item = &queue->items[queue->head & (IS31FL3733_QUEUE_LENGTH - 1)];
+  item->i2c_addr = i2c_addr;
+  // Remember page of registers, failed page select affects following writes.
+  if (reg_addr == IS31FL3733_PSR)
+  {
+    queue->page = buffer[0];
+    item->page = buffer[0];
+  }
+  else
+  {
+    item->page = (reg_addr < IS31FL3733_IMR) ? queue->page : IS31FL3733_PAGE_UNKNOWN;
+  }
+  item->reg_addr = reg_addr;
+  item->count = count;
+  item->offset = offset;
+  item->end = queue->data_head + size;
+  // Publish transaction.
+  IS31FL3733_Queue_Lock (queue);
+  queue->data_head = item->end;
+  queue->head++;
+  IS31FL3733_Queue_Unlock (queue);
+  // Start transfer if transport is idle.
+  IS31FL3733_Queue_Kick (queue);
+  return 0;
+}
+
+static uint8_t
+IS31FL3733_Queue_Read (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  IS31FL3733_QUEUE *queue = (IS31FL3733_QUEUE *)transport;
+  uint8_t status;
+  
+  // Reads must follow queued writes, e.g. page select.
+  IS31FL3733_Queue_Flush (queue);
+  // Read registers with blocking I2C function.
+  status = queue->device->i2c_read_reg (i2c_addr, reg_addr, buffer, count);
+  // Reading RESET register resets page selection.
+  if ((queue->page == IS31FL3733_GET_PAGE(IS31FL3733_RESET)) && (reg_addr == IS31FL3733_GET_ADDR(IS31FL3733_RESET)))
+  {
+    queue->bus_page = IS31FL3733_PAGE_UNKNOWN;
+    queue->misrouted = 0;
+  }
+  return status;
+}
+
+void
+IS31FL3733_Queue_Init (IS31FL3733_QUEUE *queue, IS31FL3733 *device)
+{
+  // Set transport interface functions.
+  queue->transport.write = &IS31FL3733_Queue_Write;
+  queue->transport.read = &IS31FL3733_Queue_Read;
+  // Clear queue.
+  queue->device = device;
+  queue->head = 0;
+  queue->tail = 0;
+  queue->data_head = 0;
+  queue->data_tail = 0;
+  queue->busy = 0;
+  queue->status = 0;
+  queue->page = IS31FL3733_PAGE_UNKNOWN;
+  queue->bus_page = IS31FL3733_PAGE_UNKNOWN;
+  queue->unlocked = 0;
+  queue->misrouted = 0;
+  queue->failed = 0;
+  // Attach queue to device, device selects page again through queue.
+  IS31FL3733_SetTransport (device, &queue->transport);
+}
+
+void
+IS31FL3733_Queue_Notify (IS31FL3733_QUEUE *queue, uint8_t status)
+{
+  IS31FL3733_TRANSACTION *item;
+  uint8_t idle;
+  
+  IS31FL3733_Queue_Lock (queue);
+  // Keep first error status.
+  if ((status != 0) && (queue->status == 0))
+  {
+    queue->status = status;
+  }
+  // Track page selects and registers of failed transactions.
+  item = &queue->items[queue->tail & (IS31FL3733_QUEUE_LENGTH - 1)];
+  IS31FL3733_Queue_Complete (queue, item, status);
+  // Release completed transaction and its payload.
+  queue->data_tail = item->end;
+  queue->tail++;
+  queue->busy = 0;
+  idle = (queue->head == queue->tail);
+  IS31FL3733_Queue_Unlock (queue);
+  if (idle)
+  {
+    // Report that all transactions are completed.
+    if (queue->on_idle != NULL)
+    {
+      queue->on_idle (queue);
+    }
+  }
+  else
+  {
+    // Submit next transaction.
+    IS31FL3733_Queue_Kick (queue);
+  }
+}
+
+uint8_t
+IS31FL3733_Queue_IsBusy (IS31FL3733_QUEUE *queue)
+{
+  return queue->head != queue->tail;
+}
+
+void
+IS31FL3733_Queue_Flush (IS31FL3733_QUEUE *queue)
+{
+  // Wait until all transactions are completed.
+  while (queue->head != queue->tail)
+  {
+    IS31FL3733_Queue_Wait (queue);
+  }
+  IS31FL3733_Queue_MarkStale (queue);
+}
+
+uint8_t
+IS31FL3733_Queue_GetStatus (IS31FL3733_QUEUE *queue)
+{
+  uint8_t status;
+  
+  IS31FL3733_Queue_MarkStale (queue);
+  IS31FL3733_Queue_Lock (queue);
+  status = queue->status;
+  queue->status = 0;
+  IS31FL3733_Queue_Unlock (queue);
+  return status;
+}
+
+uint8_t
+IS31FL3733_Queue_MockSubmit (IS31FL3733_QUEUE *queue, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  (void)queue;
+  (void)i2c_addr;
+  (void)reg_addr;
+  (void)buffer;
+  (void)count;
+  // Transaction stays in flight until IS31FL3733_Queue_MockComplete.
+  return 0;
+}
+
+void
+IS31FL3733_Queue_MockComplete (IS31FL3733_QUEUE *queue)
+{
+  IS31FL3733_TRANSACTION *item;
+  uint8_t status;
+  
+  // Check transaction in flight.
+  if (!queue->busy)
+  {
+    return;
+  }
+  // Transfer payload with blocking I2C function and report completion.
+  item = &queue->items[queue->tail & (IS31FL3733_QUEUE_LENGTH - 1)];
+  status = queue->device->i2c_write_reg (item->i2c_addr, item->reg_addr, &queue->data[item->offset], item->count);
+  IS31FL3733_Queue_Notify (queue, status);
+}
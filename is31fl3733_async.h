@@ -0,0 +1,108 @@
+/** ISSI IS31FL3733 asynchronous transport with transaction queue.
+  */
+#ifndef _IS31FL3733_ASYNC_H_
+#define _IS31FL3733_ASYNC_H_
+
+#include "is31fl3733.h"
+
+/// Maximum number of queued transactions. Must be power of 2.
+#ifndef IS31FL3733_QUEUE_LENGTH
+#define IS31FL3733_QUEUE_LENGTH (16)
+#endif
+
+/// Size of queued transactions payload buffer, bytes. Must be power of 2 and fit at least one full frame.
+#ifndef IS31FL3733_QUEUE_DATA_SIZE
+#define IS31FL3733_QUEUE_DATA_SIZE (512)
+#endif
+
+#if (IS31FL3733_QUEUE_LENGTH & (IS31FL3733_QUEUE_LENGTH - 1)) != 0
+#error "IS31FL3733_QUEUE_LENGTH must be power of 2"
+#endif
+
+#if ((IS31FL3733_QUEUE_DATA_SIZE & (IS31FL3733_QUEUE_DATA_SIZE - 1)) != 0) || (IS31FL3733_QUEUE_DATA_SIZE < IS31FL3733_SW * IS31FL3733_CS)
+#error "IS31FL3733_QUEUE_DATA_SIZE must be power of 2 and not less than IS31FL3733_SW * IS31FL3733_CS"
+#endif
+
+/// Number of register pages tracked for failed transactions.
+#define IS31FL3733_QUEUE_PAGES (IS31FL3733_GET_PAGE(IS31FL3733_CR) + 1)
+
+/** Queued write transaction.
+  */
+typedef struct {
+  /// Device address on I2C bus.
+  uint8_t i2c_addr;
+  /// Page of written registers, page selected by PSR write, IS31FL3733_PAGE_UNKNOWN for other common registers.
+  uint8_t page;
+  /// First register address.
+  uint8_t reg_addr;
+  /// Number of bytes to write.
+  uint8_t count;
+  /// Offset of payload in queue data buffer.
+  uint16_t offset;
+  /// Value of payload counter after this transaction.
+  uint16_t end;
+} IS31FL3733_TRANSACTION;
+
+/** Asynchronous transaction queue.
+  */
+typedef struct IS31FL3733_QUEUE IS31FL3733_QUEUE;
+struct IS31FL3733_QUEUE {
+  /// Transport interface attached to device. Must be first member.
+  IS31FL3733_TRANSPORT transport;
+  /// Device served by queue. Its blocking i2c_read_reg function is used for reads.
+  IS31FL3733 *device;
+  /// Pointer to non-blocking submit function. Transfer completion must be reported with IS31FL3733_Queue_Notify.
+  uint8_t (*i2c_submit) (IS31FL3733_QUEUE *queue, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+  /// Optional pointer to function called when all queued transactions are completed.
+  void (*on_idle) (IS31FL3733_QUEUE *queue);
+  /// Optional pointer to function called while waiting for free space or completion, e.g. to sleep until interrupt.
+  void (*wait) (IS31FL3733_QUEUE *queue);
+  /// Optional pointers to functions entering and leaving critical section, e.g. disabling I2C interrupt.
+  void (*lock) (IS31FL3733_QUEUE *queue);
+  void (*unlock) (IS31FL3733_QUEUE *queue);
+  /// Queued transactions.
+  IS31FL3733_TRANSACTION items[IS31FL3733_QUEUE_LENGTH];
+  /// Payload of queued transactions.
+  uint8_t data[IS31FL3733_QUEUE_DATA_SIZE];
+  /// Free running counters of queued and completed transactions.
+  volatile uint8_t head;
+  volatile uint8_t tail;
+  /// Free running counters of queued and released payload bytes.
+  volatile uint16_t data_head;
+  volatile uint16_t data_tail;
+  /// Transaction is submitted and not completed yet.
+  volatile uint8_t busy;
+  /// First non-zero status reported by transport, cleared by IS31FL3733_Queue_GetStatus.
+  volatile uint8_t status;
+  /// Page selected by last queued PSR write.
+  uint8_t page;
+  /// Page selected in device by completed transactions, IS31FL3733_PAGE_UNKNOWN if not known.
+  volatile uint8_t bus_page;
+  /// Last completed PSWL write unlocked page select.
+  volatile uint8_t unlocked;
+  /// Last page select failed, following writes go to bus_page instead of their page.
+  volatile uint8_t misrouted;
+  /// Pages with registers written by failed transactions, bitmask. Bit IS31FL3733_QUEUE_PAGES is set by any failure.
+  volatile uint8_t failed;
+  /// Range of registers written by failed transactions in each page: first register and register after last one.
+  volatile uint8_t failed_first[IS31FL3733_QUEUE_PAGES];
+  volatile uint16_t failed_end[IS31FL3733_QUEUE_PAGES];
+};
+
+/// Initialize queue and attach it to device as transport.
+void IS31FL3733_Queue_Init (IS31FL3733_QUEUE *queue, IS31FL3733 *device);
+/// Notify queue about completion of submitted transaction. Could be called from interrupt.
+/// Failed transaction is remembered, its registers are marked stale in device and active page becomes unknown on next queue call.
+void IS31FL3733_Queue_Notify (IS31FL3733_QUEUE *queue, uint8_t status);
+/// Check if queue has pending transactions.
+uint8_t IS31FL3733_Queue_IsBusy (IS31FL3733_QUEUE *queue);
+/// Wait until all queued transactions are completed.
+void IS31FL3733_Queue_Flush (IS31FL3733_QUEUE *queue);
+/// Get and clear first error status reported by transport. Registers of failed transactions are marked stale for IS31FL3733_Resync.
+uint8_t IS31FL3733_Queue_GetStatus (IS31FL3733_QUEUE *queue);
+/// Mock submit function: keeps transaction in flight until IS31FL3733_Queue_MockComplete is called.
+uint8_t IS31FL3733_Queue_MockSubmit (IS31FL3733_QUEUE *queue, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+/// Complete transaction in flight with device blocking i2c_write_reg function, as DMA transfer would do.
+void IS31FL3733_Queue_MockComplete (IS31FL3733_QUEUE *queue);
+
+#endif /* _IS31FL3733_ASYNC_H_ */
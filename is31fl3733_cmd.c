@@ -0,0 +1,185 @@
+#include "is31fl3733_cmd.h"
+
+#include <string.h>
+
+static uint8_t
+IS31FL3733_Cmd_Write (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  IS31FL3733_RECORDER *recorder = (IS31FL3733_RECORDER *)transport;
+  
+  (void)i2c_addr;
+  // Drop writes after overflow, command list is invalid anyway.
+  if (recorder->size - recorder->length < IS31FL3733_CMD_HEADER_SIZE + count)
+  {
+    recorder->overflow = 1;
+    return 0;
+  }
+  // Append record.
+  recorder->buffer[recorder->length++] = reg_addr;
+  recorder->buffer[recorder->length++] = count;
+  memcpy (&recorder->buffer[recorder->length], buffer, count);
+  recorder->length += count;
+  return 0;
+}
+
+static uint8_t
+IS31FL3733_Cmd_Read (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  (void)transport;
+  (void)i2c_addr;
+  (void)reg_addr;
+  memset (buffer, 0, count);
+  return 0;
+}
+
+void
+IS31FL3733_Cmd_StartRecord (IS31FL3733_RECORDER *recorder, IS31FL3733 *device, uint8_t *buffer, uint16_t size)
+{
+  recorder->transport.write = &IS31FL3733_Cmd_Write;
+  recorder->transport.read = &IS31FL3733_Cmd_Read;
+  recorder->device = device;
+  recorder->saved = device->transport;
+  recorder->buffer = buffer;
+  recorder->size = size;
+  recorder->length = 0;
+  recorder->overflow = 0;
+  // Write pending coalesced registers to device before recording.
+  if (device->batch)
+  {
+    IS31FL3733_EndBatch (device);
+    IS31FL3733_BeginBatch (device);
+  }
+  // Command list selects page itself, it could be replayed with any active page.
+  IS31FL3733_SetTransport (device, &recorder->transport);
+}
+
+uint16_t
+IS31FL3733_Cmd_StopRecord (IS31FL3733_RECORDER *recorder)
+{
+  IS31FL3733 *device = recorder->device;
+  
+  // Record pending coalesced registers.
+  if (device->batch)
+  {
+    IS31FL3733_EndBatch (device);
+    IS31FL3733_BeginBatch (device);
+  }
+  // Device registers were not changed by recording, active page is unknown.
+  IS31FL3733_SetTransport (device, recorder->saved);
+  return recorder->overflow ? 0 : recorder->length;
+}
+
+static void
+IS31FL3733_Cmd_ClearStale (uint32_t *stale, uint8_t reg_addr, uint8_t count, uint8_t size)
+{
+  uint16_t i;
+  
+  // Registers are written again, failed write marks them again.
+  for (i = reg_addr; (i < reg_addr + count) && (i < size); i++)
+  {
+    *stale &= ~((uint32_t)1 << i);
+  }
+}
+
+static void
+IS31FL3733_Cmd_Mirror (IS31FL3733 *device, uint8_t page, uint8_t reg_addr, const uint8_t *values, uint8_t count)
+{
+  uint8_t *shadow;
+  uint16_t *dirty;
+  uint16_t i;
+  
+  switch (page)
+  {
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDONOFF):
+      // LED states, open and short registers are read only.
+      for (i = reg_addr; (i < reg_addr + count) && (i < sizeof(device->leds)); i++)
+      {
+        device->leds[i] = values[i - reg_addr];
+      }
+      IS31FL3733_Cmd_ClearStale (&device->leds_stale, reg_addr, count, sizeof(device->leds));
+      return;
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDPWM):
+      shadow = device->pwm;
+      dirty = device->pwm_dirty;
+      break;
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDABM):
+      shadow = device->modes;
+      dirty = device->modes_dirty;
+      break;
+    default:
+      // Page 3 registers are mirrored by IS31FL3733_WritePagedRegs.
+      IS31FL3733_Cmd_ClearStale (&device->config_stale, reg_addr, count, IS31FL3733_CONFIG_SIZE);
+      return;
+  }
+  // Registers are written, clear them in dirty bitmask.
+  for (i = reg_addr; (i < reg_addr + count) && (i < IS31FL3733_SW * IS31FL3733_CS); i++)
+  {
+    shadow[i] = values[i - reg_addr];
+    dirty[i / IS31FL3733_CS] &= ~(0x0001 << (i % IS31FL3733_CS));
+  }
+}
+
+uint8_t
+IS31FL3733_Cmd_Replay (IS31FL3733 *device, const uint8_t *list, uint16_t length)
+{
+  uint8_t buffer[0xFF];
+  uint16_t offset = 0;
+  uint8_t page = device->page;
+  uint8_t result = 0;
+  uint8_t reg_addr;
+  uint8_t count;
+  uint8_t i;
+  
+  while (offset < length)
+  {
+    // Check record is inside command list.
+    if ((length - offset < IS31FL3733_CMD_HEADER_SIZE) || (length - offset - IS31FL3733_CMD_HEADER_SIZE < list[offset + 1]))
+    {
+      result = 1;
+      break;
+    }
+    reg_addr = list[offset];
+    count = list[offset + 1];
+    // Page select records carry single value.
+    if (((reg_addr == IS31FL3733_PSWL) || (reg_addr == IS31FL3733_PSR)) && (count != 1))
+    {
+      result = 1;
+      break;
+    }
+    offset += IS31FL3733_CMD_HEADER_SIZE;
+    // Command list could be in ROM, driver functions take writable buffer.
+    memcpy (buffer, &list[offset], count);
+    offset += count;
+    if (reg_addr == IS31FL3733_PSWL)
+    {
+      // Page is selected by driver together with following registers.
+      continue;
+    }
+    if (reg_addr == IS31FL3733_PSR)
+    {
+      page = buffer[0];
+      continue;
+    }
+    if (reg_addr >= IS31FL3733_IMR)
+    {
+      // Write common registers.
+      for (i = 0; i < count; i++)
+      {
+        IS31FL3733_WriteCommonReg (device, reg_addr + i, buffer[i]);
+      }
+      continue;
+    }
+    // Paged register before page select.
+    if (page > IS31FL3733_GET_PAGE(IS31FL3733_CR))
+    {
+      result = 1;
+      break;
+    }
+    // Write paged registers and keep shadow buffers in sync.
+    IS31FL3733_Cmd_Mirror (device, page, reg_addr, buffer, count);
+    IS31FL3733_WritePagedRegs (device, ((uint16_t)page << 8) | reg_addr, buffer, count);
+  }
+  // Sum load once from replayed LED states and PWM values, also after partial replay.
+  IS31FL3733_ComputeLoad (device);
+  return result;
+}
@@ -0,0 +1,43 @@
+/** ISSI IS31FL3733 precompiled command lists.
+  * Recorder transport captures register writes of driver calls into command list,
+  * which is replayed later without computing register values.
+  *
+  * Command list is a sequence of records: register address, number of values, values.
+  * Page select is recorded as PSWL and PSR register writes.
+  */
+#ifndef _IS31FL3733_CMD_H_
+#define _IS31FL3733_CMD_H_
+
+#include "is31fl3733.h"
+
+/// Size of record header: register address and number of values.
+#define IS31FL3733_CMD_HEADER_SIZE (2)
+
+/** Command list recorder.
+  */
+typedef struct {
+  /// Transport interface attached to device while recording. Must be first member.
+  IS31FL3733_TRANSPORT transport;
+  /// Recorded device.
+  IS31FL3733 *device;
+  /// Transport attached to device before recording.
+  IS31FL3733_TRANSPORT *saved;
+  /// Command list buffer.
+  uint8_t *buffer;
+  /// Size of command list buffer.
+  uint16_t size;
+  /// Length of recorded command list.
+  uint16_t length;
+  /// Non-zero if command list didn't fit into buffer.
+  uint8_t overflow;
+} IS31FL3733_RECORDER;
+
+/// Start recording register writes of device into buffer. Register reads return zeros and are not recorded.
+/// Writes skipped by shadow buffers of recorded device are not recorded too, so record on separate device instance.
+void IS31FL3733_Cmd_StartRecord (IS31FL3733_RECORDER *recorder, IS31FL3733 *device, uint8_t *buffer, uint16_t size);
+/// Stop recording and restore device transport. Returns length of command list, 0 if it didn't fit into buffer.
+uint16_t IS31FL3733_Cmd_StopRecord (IS31FL3733_RECORDER *recorder);
+/// Write command list to device and update device shadow buffers. Returns 0 on success, 1 if command list is malformed: truncated record, page select record without single value or paged register before page select.
+uint8_t IS31FL3733_Cmd_Replay (IS31FL3733 *device, const uint8_t *list, uint16_t length);
+
+#endif /* _IS31FL3733_CMD_H_ */
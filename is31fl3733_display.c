@@ -0,0 +1,190 @@
+#include "is31fl3733_display.h"
+
+#include <string.h>
+
+void
+IS31FL3733_Display_Init (IS31FL3733_DISPLAY *display)
+{
+  uint8_t i;
+  
+  for (i = 0; i < display->count; i++)
+  {
+    // Initialize device.
+    IS31FL3733_Init (display->tiles[i].device);
+    // First device generates clock for other devices to keep PWM cycles in phase.
+    if (display->count > 1)
+    {
+      IS31FL3733_SetSyncMode (display->tiles[i].device, (i == 0) ? IS31FL3733_SYNC_MODE_MASTER : IS31FL3733_SYNC_MODE_SLAVE);
+    }
+  }
+}
+
+void
+IS31FL3733_Display_SetGCC (IS31FL3733_DISPLAY *display, uint8_t gcc)
+{
+  uint8_t i;
+  
+  for (i = 0; i < display->count; i++)
+  {
+    IS31FL3733_SetGCC (display->tiles[i].device, gcc);
+  }
+}
+
+void
+IS31FL3733_Display_UpdateLEDPWM (IS31FL3733_DISPLAY *display, uint16_t x, uint16_t y, uint8_t value)
+{
+  IS31FL3733_TILE *tile;
+  uint8_t i;
+  
+  for (i = 0; i < display->count; i++)
+  {
+    tile = &display->tiles[i];
+    // Check if LED belongs to tile.
+    if ((x >= tile->x) && (x - tile->x < IS31FL3733_CS) && (y >= tile->y) && (y - tile->y < IS31FL3733_SW))
+    {
+      IS31FL3733_UpdateLEDPWM (tile->device, x - tile->x, y - tile->y, value);
+      return;
+    }
+  }
+}
+
+void
+IS31FL3733_Display_UpdatePWM (IS31FL3733_DISPLAY *display, uint8_t *values)
+{
+  IS31FL3733_TILE *tile;
+  uint8_t i;
+  uint8_t sw;
+  uint8_t cs;
+  
+  for (i = 0; i < display->count; i++)
+  {
+    tile = &display->tiles[i];
+    // Update tile LEDs inside display.
+    for (sw = 0; (sw < IS31FL3733_SW) && (tile->y + sw < display->height); sw++)
+    {
+      for (cs = 0; (cs < IS31FL3733_CS) && (tile->x + cs < display->width); cs++)
+      {
+        IS31FL3733_UpdateLEDPWM (tile->device, cs, sw, values[(tile->y + sw) * display->width + tile->x + cs]);
+      }
+    }
+  }
+}
+
+void
+IS31FL3733_Display_SetState (IS31FL3733_DISPLAY *display, uint8_t *states)
+{
+  IS31FL3733_TILE *tile;
+  uint8_t buffer[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint8_t i;
+  uint8_t sw;
+  uint8_t cs;
+  
+  for (i = 0; i < display->count; i++)
+  {
+    tile = &display->tiles[i];
+    // Gather tile LED states, LEDs outside display are off.
+    memset (buffer, 0, sizeof(buffer));
+    for (sw = 0; (sw < IS31FL3733_SW) && (tile->y + sw < display->height); sw++)
+    {
+      for (cs = 0; (cs < IS31FL3733_CS) && (tile->x + cs < display->width); cs++)
+      {
+        buffer[sw * IS31FL3733_CS + cs] = states[(tile->y + sw) * display->width + tile->x + cs];
+      }
+    }
+    IS31FL3733_PackState (leds, buffer, 0);
+    // Update shadow and load, changed registers are marked stale and written by flush together with PWM values.
+    for (cs = 0; cs < sizeof(leds); cs++)
+    {
+      if (leds[cs] != tile->device->leds[cs])
+      {
+        IS31FL3733_StoreLEDs (tile->device, cs, leds[cs]);
+        IS31FL3733_MarkStale (tile->device, IS31FL3733_LEDONOFF + cs, 1);
+      }
+    }
+  }
+}
+
+static uint8_t
+IS31FL3733_Display_WriteStates (IS31FL3733 *device, uint8_t sw, uint8_t rows)
+{
+  uint8_t first = sw << 1;
+  uint8_t last = (sw + rows) << 1;
+  uint8_t i;
+  
+  // Skip registers in sync at both ends of rows, write the rest in one burst.
+  while ((first < last) && !(device->leds_stale & ((uint32_t)1 << first)))
+  {
+    first++;
+  }
+  while ((last > first) && !(device->leds_stale & ((uint32_t)1 << (last - 1))))
+  {
+    last--;
+  }
+  if (first == last)
+  {
+    return 0;
+  }
+  // Registers are in sync after write, failed write marks them again.
+  for (i = first; i < last; i++)
+  {
+    device->leds_stale &= ~((uint32_t)1 << i);
+  }
+  return IS31FL3733_WritePagedRegs (device, IS31FL3733_LEDONOFF + first, &device->leds[first], last - first);
+}
+
+static void
+IS31FL3733_Display_KeepFirst (uint8_t *status, uint8_t result)
+{
+  if (*status == 0)
+  {
+    *status = result;
+  }
+}
+
+uint8_t
+IS31FL3733_Display_Flush (IS31FL3733_DISPLAY *display)
+{
+  uint8_t shared[IS31FL3733_DISPLAY_DEVICES];
+  uint8_t status = 0;
+  uint8_t i;
+  uint8_t j;
+  uint8_t sw;
+  uint8_t rows;
+  
+  // Find devices sharing I2C bus with other devices.
+  for (i = 0; i < display->count; i++)
+  {
+    shared[i] = 0;
+    for (j = 0; j < display->count; j++)
+    {
+      if ((i != j) && (display->tiles[i].bus == display->tiles[j].bus))
+      {
+        shared[i] = 1;
+      }
+    }
+  }
+  // Write full slice to devices alone on their bus. With asynchronous transports buses transfer in parallel.
+  for (i = 0; i < display->count; i++)
+  {
+    if (!shared[i])
+    {
+      IS31FL3733_Display_KeepFirst (&status, IS31FL3733_Display_WriteStates (display->tiles[i].device, 0, IS31FL3733_SW));
+      IS31FL3733_Display_KeepFirst (&status, IS31FL3733_Flush (display->tiles[i].device));
+    }
+  }
+  // Interleave bands of rows of devices sharing bus, so all their slices are updated together.
+  for (sw = 0; sw < IS31FL3733_SW; sw += IS31FL3733_DISPLAY_BAND)
+  {
+    rows = (IS31FL3733_SW - sw < IS31FL3733_DISPLAY_BAND) ? IS31FL3733_SW - sw : IS31FL3733_DISPLAY_BAND;
+    for (i = 0; i < display->count; i++)
+    {
+      if (shared[i])
+      {
+        IS31FL3733_Display_KeepFirst (&status, IS31FL3733_Display_WriteStates (display->tiles[i].device, sw, rows));
+        IS31FL3733_Display_KeepFirst (&status, IS31FL3733_FlushRows (display->tiles[i].device, sw, rows));
+      }
+    }
+  }
+  return status;
+}
@@ -0,0 +1,55 @@
+/** Virtual display tiled from multiple ISSI IS31FL3733 devices.
+  */
+#ifndef _IS31FL3733_DISPLAY_H_
+#define _IS31FL3733_DISPLAY_H_
+
+#include "is31fl3733.h"
+
+/// Maximum number of devices in display, one for each IS31FL3733_I2C_ADDR combination.
+#define IS31FL3733_DISPLAY_DEVICES (16)
+
+/// Number of rows written to each device in turn, when devices share I2C bus.
+#ifndef IS31FL3733_DISPLAY_BAND
+#define IS31FL3733_DISPLAY_BAND (2)
+#endif
+
+/** Display tile: device and position of its LED matrix in display.
+  */
+typedef struct {
+  /// Pointer to device.
+  IS31FL3733 *device;
+  /// Horizontal position of CS0 in display.
+  uint16_t x;
+  /// Vertical position of SW0 in display.
+  uint16_t y;
+  /// Number of I2C bus the device connected to. Devices on different buses are flushed independently.
+  uint8_t bus;
+} IS31FL3733_TILE;
+
+/** Display structure.
+  */
+typedef struct {
+  /// Display width in LEDs.
+  uint16_t width;
+  /// Display height in LEDs.
+  uint16_t height;
+  /// Number of tiles.
+  uint8_t count;
+  /// Display tiles. First tile is clock master, others are clock slaves.
+  IS31FL3733_TILE tiles[IS31FL3733_DISPLAY_DEVICES];
+} IS31FL3733_DISPLAY;
+
+/// Initialize all display devices and configure clock synchronization.
+void IS31FL3733_Display_Init (IS31FL3733_DISPLAY *display);
+/// Set global current control register of all devices.
+void IS31FL3733_Display_SetGCC (IS31FL3733_DISPLAY *display, uint8_t gcc);
+/// Update LED PWM duty value at {x;y} in shadow buffer of device.
+void IS31FL3733_Display_UpdateLEDPWM (IS31FL3733_DISPLAY *display, uint16_t x, uint16_t y, uint8_t value);
+/// Update LED PWM duty value for all display LED's from buffer of width * height values.
+void IS31FL3733_Display_UpdatePWM (IS31FL3733_DISPLAY *display, uint8_t *values);
+/// Set LED state for all display LED's from buffer of width * height values in shadow buffers of devices. Changed states are written by flush.
+void IS31FL3733_Display_SetState (IS31FL3733_DISPLAY *display, uint8_t *states);
+/// Write changed LED states and PWM registers of all devices. Returns first error.
+uint8_t IS31FL3733_Display_Flush (IS31FL3733_DISPLAY *display);
+
+#endif /* _IS31FL3733_DISPLAY_H_ */
@@ -0,0 +1,80 @@
+#include "is31fl3733_dither.h"
+
+#include <string.h>
+
+/// Ordered 4x4 pattern of initial accumulators, neighbour LED's with equal fraction toggle in different subframes.
+static const uint8_t IS31FL3733_Dither_Pattern[16] = {
+  0x00,0x80,0x20,0xA0,
+  0xC0,0x40,0xE0,0x60,
+  0x30,0xB0,0x10,0x90,
+  0xF0,0x70,0xD0,0x50
+};
+
+void
+IS31FL3733_Dither_Init (IS31FL3733_DITHER *dither, IS31FL3733 *device)
+{
+  uint8_t sw;
+  uint8_t cs;
+  
+  dither->device = device;
+  memset (dither->frame, 0, sizeof(dither->frame));
+  // Spread overflows of accumulators over subframes.
+  for (sw = 0; sw < IS31FL3733_SW; sw++)
+  {
+    for (cs = 0; cs < IS31FL3733_CS; cs++)
+    {
+      dither->error[sw * IS31FL3733_CS + cs] = IS31FL3733_Dither_Pattern[(sw % 4) * 4 + (cs % 4)];
+    }
+  }
+}
+
+void
+IS31FL3733_Dither_SetLEDValue (IS31FL3733_DITHER *dither, uint8_t cs, uint8_t sw, uint16_t value)
+{
+  uint8_t cs_first = (cs < IS31FL3733_CS) ? cs : 0;
+  uint8_t cs_last = (cs < IS31FL3733_CS) ? cs + 1 : IS31FL3733_CS;
+  uint8_t sw_first = (sw < IS31FL3733_SW) ? sw : 0;
+  uint8_t sw_last = (sw < IS31FL3733_SW) ? sw + 1 : IS31FL3733_SW;
+  
+  // Set individual LED, full row selected by SW, full column selected by CS or all LEDs.
+  for (sw = sw_first; sw < sw_last; sw++)
+  {
+    for (cs = cs_first; cs < cs_last; cs++)
+    {
+      dither->frame[sw * IS31FL3733_CS + cs] = value;
+    }
+  }
+}
+
+void
+IS31FL3733_Dither_SetFrame (IS31FL3733_DITHER *dither, const uint16_t *values)
+{
+  memcpy (dither->frame, values, sizeof(dither->frame));
+}
+
+void
+IS31FL3733_Dither_Update (IS31FL3733_DITHER *dither)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint16_t sum;
+  uint8_t i;
+  
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    // Add fraction to accumulator, overflow adds one PWM step.
+    sum = dither->error[i] + (dither->frame[i] & 0xFF);
+    dither->error[i] = (uint8_t)sum;
+    sum = (dither->frame[i] >> 8) + (sum >> 8);
+    // Highest values can't be rounded up.
+    pwm[i] = (sum > 0xFF) ? 0xFF : (uint8_t)sum;
+  }
+  // Store subframe, only toggled registers are marked as changed.
+  IS31FL3733_UpdateRawPWM (dither->device, pwm);
+}
+
+uint8_t
+IS31FL3733_Dither_Step (IS31FL3733_DITHER *dither)
+{
+  IS31FL3733_Dither_Update (dither);
+  return IS31FL3733_Flush (dither->device);
+}
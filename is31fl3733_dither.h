@@ -0,0 +1,33 @@
+/** ISSI IS31FL3733 high bit depth framebuffer with temporal dithering.
+  * 16-bit PWM values are rendered as stream of 8-bit subframes: fraction of each value is
+  * accumulated per LED and adds one PWM step whenever accumulator overflows. Average duty
+  * over subframes matches 16-bit value and only toggled PWM registers are written.
+  */
+#ifndef _IS31FL3733_DITHER_H_
+#define _IS31FL3733_DITHER_H_
+
+#include "is31fl3733.h"
+
+/** Dithered framebuffer.
+  */
+typedef struct {
+  /// Device showing subframes.
+  IS31FL3733 *device;
+  /// Linear PWM duty of individual LED's, 8.8 fixed point: high byte is PWM value, low byte is fraction.
+  uint16_t frame[IS31FL3733_SW * IS31FL3733_CS];
+  /// Accumulated fraction of individual LED's.
+  uint8_t error[IS31FL3733_SW * IS31FL3733_CS];
+} IS31FL3733_DITHER;
+
+/// Initialize framebuffer for device with all LED's dark.
+void IS31FL3733_Dither_Init (IS31FL3733_DITHER *dither, IS31FL3733 *device);
+/// Set 16-bit LED PWM duty value. Could be set ALL / CS / SW.
+void IS31FL3733_Dither_SetLEDValue (IS31FL3733_DITHER *dither, uint8_t cs, uint8_t sw, uint16_t value);
+/// Set 16-bit PWM duty values of all LED's from buffer. 12-bit values must be shifted left by 4 bits.
+void IS31FL3733_Dither_SetFrame (IS31FL3733_DITHER *dither, const uint16_t *values);
+/// Render next subframe to device shadow buffer only, e.g. before IS31FL3733_Limiter_Apply.
+void IS31FL3733_Dither_Update (IS31FL3733_DITHER *dither);
+/// Render next subframe and write changed PWM registers. Call at constant rate, several hundred Hz. Returns first error.
+uint8_t IS31FL3733_Dither_Step (IS31FL3733_DITHER *dither);
+
+#endif /* _IS31FL3733_DITHER_H_ */
@@ -0,0 +1,65 @@
+#include "is31fl3733_event.h"
+
+#include <stddef.h>
+
+void
+IS31FL3733_Events_Init (IS31FL3733_EVENTS *events, IS31FL3733 *device, uint8_t imr)
+{
+  events->device = device;
+  events->pending = 0;
+  // Enable interrupts in Interrupt Mask Register.
+  IS31FL3733_WriteCommonReg (device, IS31FL3733_IMR, imr);
+}
+
+void
+IS31FL3733_Events_Notify (IS31FL3733_EVENTS *events)
+{
+  // Defer bus access to IS31FL3733_Events_Process.
+  events->pending = 1;
+}
+
+uint8_t
+IS31FL3733_Events_Process (IS31FL3733_EVENTS *events)
+{
+  uint8_t isr;
+  
+  // Check INTB notification.
+  if (!events->pending)
+  {
+    return 0;
+  }
+  events->pending = 0;
+  // Read Interrupt Status Register, it is cleared on read. Common register needs no page select.
+  if (IS31FL3733_ReadCommonRegs (events->device, IS31FL3733_ISR, &isr, sizeof(uint8_t)) != 0)
+  {
+    // Keep notification, status is read again by next call.
+    events->pending = 1;
+    return 0;
+  }
+  // Dispatch ABM finish events.
+  if (events->on_abm != NULL)
+  {
+    if (isr & IS31FL3733_ISR_ABM1)
+    {
+      events->on_abm (events, IS31FL3733_ABM_NUM_1);
+    }
+    if (isr & IS31FL3733_ISR_ABM2)
+    {
+      events->on_abm (events, IS31FL3733_ABM_NUM_2);
+    }
+    if (isr & IS31FL3733_ISR_ABM3)
+    {
+      events->on_abm (events, IS31FL3733_ABM_NUM_3);
+    }
+  }
+  // Dispatch fault events.
+  if ((isr & IS31FL3733_ISR_OB) && (events->on_open != NULL))
+  {
+    events->on_open (events);
+  }
+  if ((isr & IS31FL3733_ISR_SB) && (events->on_short != NULL))
+  {
+    events->on_short (events);
+  }
+  return isr;
+}
@@ -0,0 +1,32 @@
+/** ISSI IS31FL3733 interrupt events.
+  */
+#ifndef _IS31FL3733_EVENT_H_
+#define _IS31FL3733_EVENT_H_
+
+#include "is31fl3733_abm.h"
+
+/** Interrupt events dispatcher.
+  */
+typedef struct IS31FL3733_EVENTS IS31FL3733_EVENTS;
+struct IS31FL3733_EVENTS {
+  /// Device generating interrupts.
+  IS31FL3733 *device;
+  /// Optional pointer to function called when ABM operation finished.
+  void (*on_abm) (IS31FL3733_EVENTS *events, IS31FL3733_ABM_NUM n);
+  /// Optional pointer to function called when open LED detected.
+  void (*on_open) (IS31FL3733_EVENTS *events);
+  /// Optional pointer to function called when short LED detected.
+  void (*on_short) (IS31FL3733_EVENTS *events);
+  /// INTB falling edge was notified and interrupt status is not read yet.
+  volatile uint8_t pending;
+};
+
+/// Attach dispatcher to device and enable interrupts with IMR bits.
+void IS31FL3733_Events_Init (IS31FL3733_EVENTS *events, IS31FL3733 *device, uint8_t imr);
+/// Notify dispatcher about INTB falling edge. Could be called from interrupt.
+void IS31FL3733_Events_Notify (IS31FL3733_EVENTS *events);
+/// Read and clear interrupt status if notified and call event functions. Returns ISR value, 0 if nothing happened or read failed.
+/// Notification is kept after failed read, so interrupt status is read by next call.
+uint8_t IS31FL3733_Events_Process (IS31FL3733_EVENTS *events);
+
+#endif /* _IS31FL3733_EVENT_H_ */
@@ -0,0 +1,18 @@
+/** ISSI IS31FL3733 PWM correction tables.
+  * Tables are precomputed as round(255 * f(x / 255)) and placed in read-only memory.
+  */
+#ifndef _IS31FL3733_GAMMA_H_
+#define _IS31FL3733_GAMMA_H_
+
+#include "is31fl3733.h"
+
+/// Gamma 1.8 correction table.
+extern const uint8_t IS31FL3733_GAMMA_1_8[256];
+/// Gamma 2.2 correction table.
+extern const uint8_t IS31FL3733_GAMMA_2_2[256];
+/// Gamma 2.8 correction table.
+extern const uint8_t IS31FL3733_GAMMA_2_8[256];
+/// CIE 1931 lightness correction table.
+extern const uint8_t IS31FL3733_GAMMA_CIE1931[256];
+
+#endif /* _IS31FL3733_GAMMA_H_ */
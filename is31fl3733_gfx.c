@@ -0,0 +1,231 @@
+#include "is31fl3733_gfx.h"
+
+#include <string.h>
+
+/** Rectangle clipped to matrix.
+  */
+typedef struct {
+  /// First CS line.
+  uint8_t x;
+  /// First SW line.
+  uint8_t y;
+  /// Number of CS lines.
+  uint8_t w;
+  /// Number of SW lines.
+  uint8_t h;
+  /// Number of clipped columns on the left.
+  uint8_t skip_x;
+  /// Number of clipped rows on the top.
+  uint8_t skip_y;
+} IS31FL3733_GFX_RECT;
+
+static uint8_t
+IS31FL3733_Gfx_Clip (IS31FL3733_GFX_RECT *rect, int8_t x, int8_t y, uint8_t w, uint8_t h)
+{
+  int16_t x0 = x;
+  int16_t y0 = y;
+  int16_t x1 = x0 + w;
+  int16_t y1 = y0 + h;
+  
+  rect->skip_x = (x0 < 0) ? -x0 : 0;
+  rect->skip_y = (y0 < 0) ? -y0 : 0;
+  // Limit rectangle to matrix.
+  x0 = (x0 < 0) ? 0 : x0;
+  y0 = (y0 < 0) ? 0 : y0;
+  x1 = (x1 > IS31FL3733_CS) ? IS31FL3733_CS : x1;
+  y1 = (y1 > IS31FL3733_SW) ? IS31FL3733_SW : y1;
+  if ((x0 >= x1) || (y0 >= y1))
+  {
+    return 0;
+  }
+  rect->x = (uint8_t)x0;
+  rect->y = (uint8_t)y0;
+  rect->w = (uint8_t)(x1 - x0);
+  rect->h = (uint8_t)(y1 - y0);
+  return 1;
+}
+
+static void
+IS31FL3733_Gfx_Fill (uint8_t *pixels, IS31FL3733_GFX_RECT *rect, uint8_t value)
+{
+  uint8_t sw;
+  
+  for (sw = rect->y; sw < rect->y + rect->h; sw++)
+  {
+    memset (&pixels[sw * IS31FL3733_CS + rect->x], value, rect->w);
+  }
+}
+
+static void
+IS31FL3733_Gfx_Blit (uint8_t *pixels, IS31FL3733_GFX_RECT *rect, const uint8_t *src, uint8_t stride, uint16_t key)
+{
+  uint8_t sw;
+  uint8_t cs;
+  
+  // Skip clipped source pixels.
+  src += rect->skip_y * stride + rect->skip_x;
+  for (sw = rect->y; sw < rect->y + rect->h; sw++, src += stride)
+  {
+    for (cs = 0; cs < rect->w; cs++)
+    {
+      if (src[cs] != key)
+      {
+        pixels[sw * IS31FL3733_CS + rect->x + cs] = src[cs];
+      }
+    }
+  }
+}
+
+static void
+IS31FL3733_Gfx_Scroll (uint8_t *pixels, IS31FL3733_GFX_RECT *rect, int8_t dx, int8_t dy, uint8_t value)
+{
+  uint8_t copy[IS31FL3733_SW * IS31FL3733_CS];
+  int16_t cs;
+  int16_t sw;
+  
+  memcpy (copy, pixels, sizeof(copy));
+  for (sw = rect->y; sw < rect->y + rect->h; sw++)
+  {
+    for (cs = rect->x; cs < rect->x + rect->w; cs++)
+    {
+      // Take pixel moved to this position, if it was inside rectangle.
+      if ((cs - dx >= rect->x) && (cs - dx < rect->x + rect->w) && (sw - dy >= rect->y) && (sw - dy < rect->y + rect->h))
+      {
+        pixels[sw * IS31FL3733_CS + cs] = copy[(sw - dy) * IS31FL3733_CS + cs - dx];
+      }
+      else
+      {
+        pixels[sw * IS31FL3733_CS + cs] = value;
+      }
+    }
+  }
+}
+
+static void
+IS31FL3733_Gfx_UnpackState (IS31FL3733 *device, uint8_t *states)
+{
+  uint8_t i;
+  
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    states[i] = (device->leds[i / 8] >> (i % 8)) & 0x01;
+  }
+}
+
+static void
+IS31FL3733_Gfx_WriteState (IS31FL3733 *device, const uint8_t *states)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  
+  // Write only changed registers.
+  IS31FL3733_PackState (leds, states, 0);
+  IS31FL3733_SetStatePacked (device, leds);
+}
+
+void
+IS31FL3733_Gfx_FillPWM (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, uint8_t value)
+{
+  IS31FL3733_GFX_RECT rect;
+  uint8_t sw;
+  uint8_t cs;
+  
+  if (!IS31FL3733_Gfx_Clip (&rect, x, y, w, h))
+  {
+    return;
+  }
+  // Update corrected values, only changed registers are marked for flush.
+  for (sw = rect.y; sw < rect.y + rect.h; sw++)
+  {
+    for (cs = rect.x; cs < rect.x + rect.w; cs++)
+    {
+      IS31FL3733_UpdateLEDPWM (device, cs, sw, value);
+    }
+  }
+}
+
+void
+IS31FL3733_Gfx_BlitPWM (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, const uint8_t *src, uint8_t stride, uint16_t key)
+{
+  IS31FL3733_GFX_RECT rect;
+  uint8_t sw;
+  uint8_t cs;
+  
+  if (!IS31FL3733_Gfx_Clip (&rect, x, y, w, h))
+  {
+    return;
+  }
+  // Skip clipped source pixels.
+  src += rect.skip_y * stride + rect.skip_x;
+  for (sw = rect.y; sw < rect.y + rect.h; sw++, src += stride)
+  {
+    for (cs = 0; cs < rect.w; cs++)
+    {
+      // Update corrected values of opaque pixels.
+      if (src[cs] != key)
+      {
+        IS31FL3733_UpdateLEDPWM (device, rect.x + cs, sw, src[cs]);
+      }
+    }
+  }
+}
+
+void
+IS31FL3733_Gfx_ScrollPWM (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, int8_t dx, int8_t dy, uint8_t value)
+{
+  IS31FL3733_GFX_RECT rect;
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  
+  if (!IS31FL3733_Gfx_Clip (&rect, x, y, w, h))
+  {
+    return;
+  }
+  // Move already corrected values.
+  memcpy (pwm, device->pwm, sizeof(pwm));
+  IS31FL3733_Gfx_Scroll (pwm, &rect, dx, dy, IS31FL3733_CorrectPWM (device, value));
+  IS31FL3733_UpdateRawPWM (device, pwm);
+}
+
+void
+IS31FL3733_Gfx_FillState (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, IS31FL3733_LED_STATE state)
+{
+  IS31FL3733_GFX_RECT rect;
+  uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+  
+  if (!IS31FL3733_Gfx_Clip (&rect, x, y, w, h))
+  {
+    return;
+  }
+  IS31FL3733_Gfx_UnpackState (device, states);
+  IS31FL3733_Gfx_Fill (states, &rect, state);
+  IS31FL3733_Gfx_WriteState (device, states);
+}
+
+void
+IS31FL3733_Gfx_BlitState (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, const uint8_t *src, uint8_t stride, uint16_t key)
+{
+  IS31FL3733_GFX_RECT rect;
+  uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+  
+  if (!IS31FL3733_Gfx_Clip (&rect, x, y, w, h))
+  {
+    return;
+  }
+  IS31FL3733_Gfx_UnpackState (device, states);
+  IS31FL3733_Gfx_Blit (states, &rect, src, stride, key);
+  IS31FL3733_Gfx_WriteState (device, states);
+}
+
+void
+IS31FL3733_Gfx_ScrollState (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, int8_t dx, int8_t dy, IS31FL3733_LED_STATE state)
+{
+  IS31FL3733_GFX_RECT rect;
+  uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+  
+  if (!IS31FL3733_Gfx_Clip (&rect, x, y, w, h))
+  {
+    return;
+  }
+  IS31FL3733_Gfx_UnpackState (device, states);
+  IS31FL3733_Gfx_Scroll (states, &rect, dx, dy, state);
+  IS31FL3733_Gfx_WriteState (device, states);
+}
@@ -0,0 +1,28 @@
+/** ISSI IS31FL3733 raster operations.
+  * X coordinate is CS line, Y coordinate is SW line. Rectangles are clipped to matrix,
+  * so sprites could be placed partially outside. PWM operations update shadow buffer only:
+  * call IS31FL3733_Flush to write changed registers in row-contiguous bursts. LED state
+  * operations write changed LEDONOFF registers immediately.
+  */
+#ifndef _IS31FL3733_GFX_H_
+#define _IS31FL3733_GFX_H_
+
+#include "is31fl3733.h"
+
+/// Blit all source pixels, no transparency key.
+#define IS31FL3733_GFX_NO_KEY (0x0100)
+
+/// Fill rectangle with PWM value.
+void IS31FL3733_Gfx_FillPWM (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, uint8_t value);
+/// Copy PWM values from source buffer with stride in bytes to rectangle, source pixels equal to key are skipped.
+void IS31FL3733_Gfx_BlitPWM (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, const uint8_t *src, uint8_t stride, uint16_t key);
+/// Move PWM values inside rectangle by dx, dy and fill uncovered LED's with PWM value.
+void IS31FL3733_Gfx_ScrollPWM (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, int8_t dx, int8_t dy, uint8_t value);
+/// Set state of LED's in rectangle.
+void IS31FL3733_Gfx_FillState (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, IS31FL3733_LED_STATE state);
+/// Set state of LED's in rectangle from source buffer with stride in bytes: LED is ON if value is not 0, source pixels equal to key are skipped.
+void IS31FL3733_Gfx_BlitState (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, const uint8_t *src, uint8_t stride, uint16_t key);
+/// Move LED states inside rectangle by dx, dy and set uncovered LED's to state.
+void IS31FL3733_Gfx_ScrollState (IS31FL3733 *device, int8_t x, int8_t y, uint8_t w, uint8_t h, int8_t dx, int8_t dy, IS31FL3733_LED_STATE state);
+
+#endif /* _IS31FL3733_GFX_H_ */
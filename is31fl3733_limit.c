@@ -0,0 +1,90 @@
+#include "is31fl3733_limit.h"
+
+void
+IS31FL3733_Limiter_Init (IS31FL3733_LIMITER *limiter, IS31FL3733 *device, uint16_t current, uint16_t budget, uint8_t gcc, uint8_t hysteresis)
+{
+  limiter->device = device;
+  limiter->current = current;
+  limiter->budget = budget;
+  limiter->gcc = gcc;
+  limiter->hysteresis = hysteresis;
+}
+
+static uint8_t
+IS31FL3733_Limiter_GetActive (IS31FL3733_LIMITER *limiter)
+{
+  // GCC written to device, also by application.
+  return limiter->device->config[IS31FL3733_GET_ADDR(IS31FL3733_GCC)];
+}
+
+static uint8_t
+IS31FL3733_Limiter_GetGCC (IS31FL3733_LIMITER *limiter)
+{
+  uint32_t load;
+  uint32_t gcc;
+  
+  // Current is current * (gcc / 255) * (load / 255), find the largest GCC within budget.
+  load = (uint32_t)limiter->current * limiter->device->load;
+  if (load == 0)
+  {
+    return limiter->gcc;
+  }
+  gcc = (uint32_t)limiter->budget * (255 * 255) / load;
+  return (gcc < limiter->gcc) ? (uint8_t)gcc : limiter->gcc;
+}
+
+static uint8_t
+IS31FL3733_Limiter_SetShutdown (IS31FL3733_LIMITER *limiter, uint8_t shutdown)
+{
+  uint8_t cr;
+  
+  // Software shutdown is entered with cleared SSD bit, skip write if device is already in requested state.
+  cr = limiter->device->config[IS31FL3733_GET_ADDR(IS31FL3733_CR)];
+  if ((shutdown != 0) == ((cr & IS31FL3733_CR_SSD) == 0))
+  {
+    return 0;
+  }
+  cr &= ~IS31FL3733_CR_SSD;
+  return IS31FL3733_WritePagedReg (limiter->device, IS31FL3733_CR, shutdown ? cr : cr | IS31FL3733_CR_SSD);
+}
+
+uint8_t
+IS31FL3733_Limiter_Apply (IS31FL3733_LIMITER *limiter)
+{
+  uint8_t status = 0;
+  uint8_t result;
+  uint8_t gcc;
+  
+  gcc = IS31FL3733_Limiter_GetGCC (limiter);
+  // Lower GCC before brighter frame is written, budget is kept for old and new frame.
+  if (gcc < IS31FL3733_Limiter_GetActive (limiter))
+  {
+    status = IS31FL3733_WritePagedReg (limiter->device, IS31FL3733_GCC, gcc);
+  }
+  // Write frame to device.
+  result = IS31FL3733_Flush (limiter->device);
+  if (status == 0)
+  {
+    status = result;
+  }
+  // Raise GCC after dimmer frame is written, if it grows enough or budget is not limiting anymore.
+  if ((gcc > IS31FL3733_Limiter_GetActive (limiter)) &&
+      ((gcc - IS31FL3733_Limiter_GetActive (limiter) >= limiter->hysteresis) || (gcc == limiter->gcc)))
+  {
+    result = IS31FL3733_WritePagedReg (limiter->device, IS31FL3733_GCC, gcc);
+    if (status == 0)
+    {
+      status = result;
+    }
+  }
+  // Shut down device while all LEDs are dark, wake it up with first lit LED.
+  result = IS31FL3733_Limiter_SetShutdown (limiter, limiter->device->load == 0);
+  return (status != 0) ? status : result;
+}
+
+uint16_t
+IS31FL3733_Limiter_GetCurrent (IS31FL3733_LIMITER *limiter)
+{
+  // Calculate current in two steps to fit into 32 bits.
+  return (uint16_t)((uint32_t)limiter->current * limiter->device->load / 255 * IS31FL3733_Limiter_GetActive (limiter) / 255);
+}
@@ -0,0 +1,34 @@
+/** ISSI IS31FL3733 power budget limiter.
+  * Limiter scales Global Current Control to keep estimated total LED current under budget
+  * and puts device into software shutdown while all LEDs are dark.
+  * Active GCC and shutdown state are read from device configuration shadow on each apply, so direct
+  * GCC or CR writes are seen, but limiter owns GCC: change maximum GCC in limiter instead of IS31FL3733_SetGCC.
+  */
+#ifndef _IS31FL3733_LIMIT_H_
+#define _IS31FL3733_LIMIT_H_
+
+#include "is31fl3733.h"
+
+/** Power budget limiter.
+  */
+typedef struct {
+  /// Limited device.
+  IS31FL3733 *device;
+  /// Current of one LED with GCC and PWM set to 255, e.g. 840 / R_EXT in mA.
+  uint16_t current;
+  /// Total LED current budget in the same units.
+  uint16_t budget;
+  /// GCC value used while budget is not exceeded.
+  uint8_t gcc;
+  /// GCC is raised only when it may grow by at least this value, to avoid writes on small load changes.
+  uint8_t hysteresis;
+} IS31FL3733_LIMITER;
+
+/// Attach limiter to initialized device with LED current, total current budget, maximum GCC and hysteresis.
+void IS31FL3733_Limiter_Init (IS31FL3733_LIMITER *limiter, IS31FL3733 *device, uint16_t current, uint16_t budget, uint8_t gcc, uint8_t hysteresis);
+/// Write changed PWM and mode registers and adjust GCC for new load, so budget is kept during update. Returns first error.
+uint8_t IS31FL3733_Limiter_Apply (IS31FL3733_LIMITER *limiter);
+/// Get estimated total LED current with GCC written to device.
+uint16_t IS31FL3733_Limiter_GetCurrent (IS31FL3733_LIMITER *limiter);
+
+#endif /* _IS31FL3733_LIMIT_H_ */
@@ -0,0 +1,128 @@
+#include "is31fl3733_mailbox.h"
+
+#include <string.h>
+
+static void
+IS31FL3733_Mailbox_Release (IS31FL3733_MAILBOX *mailbox, uint8_t n)
+{
+  atomic_store_explicit (&mailbox->busy[n], 0, memory_order_release);
+}
+
+void
+IS31FL3733_Mailbox_Init (IS31FL3733_MAILBOX *mailbox, IS31FL3733 *device)
+{
+  uint8_t i;
+  
+  mailbox->device = device;
+  for (i = 0; i < IS31FL3733_MAILBOX_FRAMES; i++)
+  {
+    atomic_init (&mailbox->busy[i], 0);
+  }
+  atomic_init (&mailbox->latest, IS31FL3733_MAILBOX_NONE);
+  atomic_init (&mailbox->dropped, 0);
+}
+
+IS31FL3733_FRAME *
+IS31FL3733_Mailbox_Acquire (IS31FL3733_MAILBOX *mailbox)
+{
+  unsigned char expected;
+  uint8_t i;
+  
+  for (i = 0; i < IS31FL3733_MAILBOX_FRAMES; i++)
+  {
+    // Claim free frame buffer, other producers could claim it first.
+    expected = 0;
+    if (atomic_compare_exchange_strong_explicit (&mailbox->busy[i], &expected, 1, memory_order_acquire, memory_order_relaxed))
+    {
+      mailbox->frames[i].flags = 0;
+      return &mailbox->frames[i];
+    }
+  }
+  return NULL;
+}
+
+void
+IS31FL3733_Mailbox_Publish (IS31FL3733_MAILBOX *mailbox, IS31FL3733_FRAME *frame)
+{
+  IS31FL3733_FRAME *older;
+  unsigned char expected;
+  uint8_t old;
+  
+  do
+  {
+    // Take unwritten frame out of mailbox, whoever takes frame index owns it.
+    old = atomic_exchange_explicit (&mailbox->latest, IS31FL3733_MAILBOX_NONE, memory_order_acq_rel);
+    if (old != IS31FL3733_MAILBOX_NONE)
+    {
+      // Keep sections of older frame, which are not updated by new frame.
+      older = &mailbox->frames[old];
+      if ((older->flags & IS31FL3733_FRAME_PWM) && !(frame->flags & IS31FL3733_FRAME_PWM))
+      {
+        memcpy (frame->pwm, older->pwm, sizeof(frame->pwm));
+      }
+      if ((older->flags & IS31FL3733_FRAME_STATE) && !(frame->flags & IS31FL3733_FRAME_STATE))
+      {
+        memcpy (frame->leds, older->leds, sizeof(frame->leds));
+      }
+      frame->flags |= older->flags;
+      // Older frame is replaced before bus thread took it.
+      IS31FL3733_Mailbox_Release (mailbox, old);
+      atomic_fetch_add_explicit (&mailbox->dropped, 1, memory_order_relaxed);
+    }
+    // Publish frame, unless other producer published frame meanwhile: merge it too.
+    expected = IS31FL3733_MAILBOX_NONE;
+  }
+  while (!atomic_compare_exchange_strong_explicit (&mailbox->latest, &expected, (unsigned char)(frame - mailbox->frames),
+                                                  memory_order_acq_rel, memory_order_acquire));
+}
+
+uint8_t
+IS31FL3733_Mailbox_Submit (IS31FL3733_MAILBOX *mailbox, const uint8_t *pwm, const uint8_t *states)
+{
+  IS31FL3733_FRAME *frame;
+  
+  frame = IS31FL3733_Mailbox_Acquire (mailbox);
+  if (frame == NULL)
+  {
+    return 1;
+  }
+  if (pwm != NULL)
+  {
+    memcpy (frame->pwm, pwm, sizeof(frame->pwm));
+    frame->flags |= IS31FL3733_FRAME_PWM;
+  }
+  if (states != NULL)
+  {
+    IS31FL3733_PackState (frame->leds, states, 0);
+    frame->flags |= IS31FL3733_FRAME_STATE;
+  }
+  IS31FL3733_Mailbox_Publish (mailbox, frame);
+  return 0;
+}
+
+uint8_t
+IS31FL3733_Mailbox_Process (IS31FL3733_MAILBOX *mailbox)
+{
+  IS31FL3733_FRAME *frame;
+  uint8_t n;
+  
+  // Take newest frame, producers can't drop it after that.
+  n = atomic_exchange_explicit (&mailbox->latest, IS31FL3733_MAILBOX_NONE, memory_order_acq_rel);
+  if (n == IS31FL3733_MAILBOX_NONE)
+  {
+    return 0;
+  }
+  frame = &mailbox->frames[n];
+  // Write only registers changed since previous frame.
+  if (frame->flags & IS31FL3733_FRAME_PWM)
+  {
+    IS31FL3733_UpdatePWM (mailbox->device, frame->pwm);
+    IS31FL3733_Flush (mailbox->device);
+  }
+  if (frame->flags & IS31FL3733_FRAME_STATE)
+  {
+    IS31FL3733_SetStatePacked (mailbox->device, frame->leds);
+  }
+  IS31FL3733_Mailbox_Release (mailbox, n);
+  return 1;
+}
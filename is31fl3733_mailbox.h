@@ -0,0 +1,64 @@
+/** Lock-free frame mailbox for ISSI IS31FL3733 shared by rendering threads and bus thread.
+  * Producers publish frames without blocking, bus thread writes the newest frame. Sections of older
+  * unwritten frames, which newer frame doesn't have, are merged into it. Requires C11 atomics.
+  */
+#ifndef _IS31FL3733_MAILBOX_H_
+#define _IS31FL3733_MAILBOX_H_
+
+#include <stdatomic.h>
+
+#include "is31fl3733.h"
+
+/// Maximum number of threads filling frames at the same time.
+#ifndef IS31FL3733_MAILBOX_PRODUCERS
+#define IS31FL3733_MAILBOX_PRODUCERS (1)
+#endif
+
+/// Number of frame buffers: one per producer, newest published and one written to device.
+#define IS31FL3733_MAILBOX_FRAMES (IS31FL3733_MAILBOX_PRODUCERS + 2)
+
+/// No frame published.
+#define IS31FL3733_MAILBOX_NONE (0xFF)
+
+/// Frame flags.
+#define IS31FL3733_FRAME_PWM   (0x01) /// Frame has PWM values.
+#define IS31FL3733_FRAME_STATE (0x02) /// Frame has LED states.
+
+/** Frame buffer.
+  */
+typedef struct {
+  /// Frame content flags.
+  uint8_t flags;
+  /// PWM values in register order.
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  /// LED states in LEDONOFF layout.
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+} IS31FL3733_FRAME;
+
+/** Frame mailbox.
+  */
+typedef struct {
+  /// Device written by bus thread.
+  IS31FL3733 *device;
+  /// Frame buffers.
+  IS31FL3733_FRAME frames[IS31FL3733_MAILBOX_FRAMES];
+  /// Non-zero if frame buffer is owned by producer, mailbox or bus thread.
+  atomic_uchar busy[IS31FL3733_MAILBOX_FRAMES];
+  /// Newest published frame, IS31FL3733_MAILBOX_NONE if it was taken by bus thread.
+  atomic_uchar latest;
+  /// Number of published frames replaced by newer frame before bus thread took them.
+  atomic_uint dropped;
+} IS31FL3733_MAILBOX;
+
+/// Initialize empty mailbox for device.
+void IS31FL3733_Mailbox_Init (IS31FL3733_MAILBOX *mailbox, IS31FL3733 *device);
+/// Take free frame buffer for filling. Returns NULL if more than IS31FL3733_MAILBOX_PRODUCERS frames are filled at the same time.
+IS31FL3733_FRAME *IS31FL3733_Mailbox_Acquire (IS31FL3733_MAILBOX *mailbox);
+/// Publish filled frame buffer. It replaces unwritten older frame, sections of older frame missing in frame flags are copied to frame buffer.
+void IS31FL3733_Mailbox_Publish (IS31FL3733_MAILBOX *mailbox, IS31FL3733_FRAME *frame);
+/// Copy PWM values and LED states (any could be NULL) to frame buffer and publish it. Returns 0 on success, 1 if no frame buffer is free.
+uint8_t IS31FL3733_Mailbox_Submit (IS31FL3733_MAILBOX *mailbox, const uint8_t *pwm, const uint8_t *states);
+/// Write newest published frame to device from bus thread. Returns 1 if frame was written, 0 if no new frame.
+uint8_t IS31FL3733_Mailbox_Process (IS31FL3733_MAILBOX *mailbox);
+
+#endif /* _IS31FL3733_MAILBOX_H_ */
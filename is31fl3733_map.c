@@ -0,0 +1,136 @@
+#include "is31fl3733_map.h"
+
+#include <string.h>
+
+uint8_t
+IS31FL3733_Map_Init (IS31FL3733_MAP *map, const IS31FL3733_MAP_LAYOUT *layout)
+{
+  uint8_t x;
+  uint8_t y;
+  uint8_t c;
+  uint8_t mx;
+  uint8_t my;
+  uint8_t px;
+  uint8_t py;
+  uint16_t cs;
+  uint16_t sw;
+  uint8_t offset;
+  uint8_t used = 0;
+  
+  // Pixel has 1 to 3 channels, each with CS offset in order.
+  if ((layout->channels == 0) || (layout->channels > sizeof(layout->order)))
+  {
+    return 1;
+  }
+  // Channel offsets are permutation of 0 to channels - 1, so channels of pixel don't overlap.
+  for (c = 0; c < layout->channels; c++)
+  {
+    if ((layout->order[c] >= layout->channels) || (used & (0x01 << layout->order[c])))
+    {
+      return 1;
+    }
+    used |= 0x01 << layout->order[c];
+  }
+  // Logical frame is not empty and value index must fit into gather table.
+  if ((layout->width * layout->height == 0) || (layout->width * layout->height * layout->channels > IS31FL3733_SW * IS31FL3733_CS))
+  {
+    return 1;
+  }
+  // Unmapped registers read first value and mask it out.
+  memset (map->index, 0, sizeof(map->index));
+  memset (map->mask, 0, sizeof(map->mask));
+  for (y = 0; y < layout->height; y++)
+  {
+    for (x = 0; x < layout->width; x++)
+    {
+      // Mirror logical frame.
+      mx = (layout->mirror & IS31FL3733_MAP_MIRROR_X) ? layout->width - 1 - x : x;
+      my = (layout->mirror & IS31FL3733_MAP_MIRROR_Y) ? layout->height - 1 - y : y;
+      // Rotate logical frame clockwise to physical pixel grid.
+      switch (layout->rotation)
+      {
+        case IS31FL3733_MAP_ROTATE_90:
+          px = layout->height - 1 - my;
+          py = mx;
+          break;
+        case IS31FL3733_MAP_ROTATE_180:
+          px = layout->width - 1 - mx;
+          py = layout->height - 1 - my;
+          break;
+        case IS31FL3733_MAP_ROTATE_270:
+          px = my;
+          py = layout->width - 1 - mx;
+          break;
+        default:
+          px = mx;
+          py = my;
+          break;
+      }
+      for (c = 0; c < layout->channels; c++)
+      {
+        // Calculate CS and SW lines of channel LED.
+        cs = layout->cs + px * layout->channels + layout->order[c];
+        sw = layout->sw + py;
+        // Skip LEDs outside of matrix.
+        if ((cs >= IS31FL3733_CS) || (sw >= IS31FL3733_SW))
+        {
+          continue;
+        }
+        // Skip LEDs not populated on board.
+        if ((layout->unpopulated != NULL) && (layout->unpopulated[(sw << 1) + (cs / 8)] & (0x01 << (cs % 8))))
+        {
+          continue;
+        }
+        offset = sw * IS31FL3733_CS + cs;
+        map->index[offset] = (y * layout->width + x) * layout->channels + c;
+        map->mask[offset] = 0xFF;
+      }
+    }
+  }
+  return 0;
+}
+
+void
+IS31FL3733_Map_Gather (const IS31FL3733_MAP *map, uint8_t *dst, const uint8_t *src)
+{
+  uint8_t i;
+  
+  // Single table driven pass without branches.
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    dst[i] = src[map->index[i]] & map->mask[i];
+  }
+}
+
+void
+IS31FL3733_Map_SetPWM (IS31FL3733 *device, const IS31FL3733_MAP *map, const uint8_t *frame)
+{
+  uint8_t values[IS31FL3733_SW * IS31FL3733_CS];
+  
+  // Convert logical frame to register order.
+  IS31FL3733_Map_Gather (map, values, frame);
+  // Write LED PWM values to device.
+  IS31FL3733_SetPWM (device, values);
+}
+
+void
+IS31FL3733_Map_UpdatePWM (IS31FL3733 *device, const IS31FL3733_MAP *map, const uint8_t *frame)
+{
+  uint8_t values[IS31FL3733_SW * IS31FL3733_CS];
+  
+  // Convert logical frame to register order.
+  IS31FL3733_Map_Gather (map, values, frame);
+  // Update LED PWM values in shadow buffer.
+  IS31FL3733_UpdatePWM (device, values);
+}
+
+void
+IS31FL3733_Map_SetState (IS31FL3733 *device, const IS31FL3733_MAP *map, const uint8_t *frame)
+{
+  uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+  
+  // Convert logical frame to register order.
+  IS31FL3733_Map_Gather (map, states, frame);
+  // Write LED states to device.
+  IS31FL3733_SetState (device, states);
+}
@@ -0,0 +1,64 @@
+/** ISSI IS31FL3733 logical to physical LED mapping.
+  */
+#ifndef _IS31FL3733_MAP_H_
+#define _IS31FL3733_MAP_H_
+
+#include "is31fl3733.h"
+
+/// Mirror flags, applied to logical frame before rotation.
+#define IS31FL3733_MAP_MIRROR_X (0x01) ///< Mirror horizontally.
+#define IS31FL3733_MAP_MIRROR_Y (0x02) ///< Mirror vertically.
+
+/// Rotation of logical frame clockwise.
+typedef enum {
+  IS31FL3733_MAP_ROTATE_0   = 0x00, ///< No rotation.
+  IS31FL3733_MAP_ROTATE_90  = 0x01, ///< Rotation by 90 degrees.
+  IS31FL3733_MAP_ROTATE_180 = 0x02, ///< Rotation by 180 degrees.
+  IS31FL3733_MAP_ROTATE_270 = 0x03  ///< Rotation by 270 degrees.
+} IS31FL3733_MAP_ROTATION;
+
+/** Description of logical frame layout on LED matrix.
+  */
+typedef struct {
+  /// Logical frame width in pixels.
+  uint8_t width;
+  /// Logical frame height in pixels.
+  uint8_t height;
+  /// Number of channels in pixel: 1 for single color LEDs, 3 for RGB LEDs.
+  uint8_t channels;
+  /// CS line offset of each channel inside pixel, permutation of 0 to channels - 1, e.g. {0, 1, 2} for RGB LED wired to consecutive CS lines.
+  uint8_t order[3];
+  /// Rotation of logical frame.
+  IS31FL3733_MAP_ROTATION rotation;
+  /// Mirror flags.
+  uint8_t mirror;
+  /// CS line of physical pixel grid origin.
+  uint8_t cs;
+  /// SW line of physical pixel grid origin.
+  uint8_t sw;
+  /// Optional bitmask in LEDONOFF layout of LEDs not populated on board, NULL if all LEDs are populated.
+  const uint8_t *unpopulated;
+} IS31FL3733_MAP_LAYOUT;
+
+/** Precomputed gather table.
+  */
+typedef struct {
+  /// Index of logical frame value for each register.
+  uint8_t index[IS31FL3733_SW * IS31FL3733_CS];
+  /// 0xFF if register is mapped to logical frame value, 0x00 otherwise.
+  uint8_t mask[IS31FL3733_SW * IS31FL3733_CS];
+} IS31FL3733_MAP;
+
+/// Build gather table from layout. Returns 0 on success, 1 if number of channels is not 1 to 3, order is not permutation of 0 to channels - 1,
+/// logical frame is empty or has more than IS31FL3733_SW * IS31FL3733_CS values.
+uint8_t IS31FL3733_Map_Init (IS31FL3733_MAP *map, const IS31FL3733_MAP_LAYOUT *layout);
+/// Convert logical frame to register order, unmapped registers are set to 0.
+void IS31FL3733_Map_Gather (const IS31FL3733_MAP *map, uint8_t *dst, const uint8_t *src);
+/// Set LED PWM duty values from logical frame.
+void IS31FL3733_Map_SetPWM (IS31FL3733 *device, const IS31FL3733_MAP *map, const uint8_t *frame);
+/// Update LED PWM duty values in shadow buffer from logical frame.
+void IS31FL3733_Map_UpdatePWM (IS31FL3733 *device, const IS31FL3733_MAP *map, const uint8_t *frame);
+/// Set LED states from logical frame: LEDs with non-zero values are turned on.
+void IS31FL3733_Map_SetState (IS31FL3733 *device, const IS31FL3733_MAP *map, const uint8_t *frame);
+
+#endif /* _IS31FL3733_MAP_H_ */
@@ -0,0 +1,315 @@
+#include "is31fl3733_sched.h"
+
+#include <stddef.h>
+#include <string.h>
+
+static IS31FL3733_SCHED_ENTRY *
+IS31FL3733_Sched_Entry (IS31FL3733_SCHED_PORT *port, uint8_t n)
+{
+  return &port->entries[(port->head + n) % IS31FL3733_SCHED_ENTRIES];
+}
+
+static uint8_t
+IS31FL3733_Sched_Send (IS31FL3733_SCHED *sched, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  uint8_t status;
+  uint8_t attempt = 0;
+  
+  // Repeat failed write as driver does.
+  do
+  {
+    status = sched->i2c_write_reg (i2c_addr, reg_addr, buffer, count);
+  }
+  while ((status != 0) && (attempt++ < IS31FL3733_RETRIES));
+  // Keep first error.
+  if (sched->status == 0)
+  {
+    sched->status = status;
+  }
+  return status;
+}
+
+static uint8_t
+IS31FL3733_Sched_SelectPage (IS31FL3733_SCHED_PORT *port, uint8_t page)
+{
+  uint8_t value = IS31FL3733_PSWL_ENABLE;
+  uint8_t status;
+  
+  // Unlock and write Page Select register, page is unknown after failure.
+  status = IS31FL3733_Sched_Send (port->sched, port->device->address, IS31FL3733_PSWL, &value, sizeof(uint8_t));
+  if (status == 0)
+  {
+    status = IS31FL3733_Sched_Send (port->sched, port->device->address, IS31FL3733_PSR, &page, sizeof(uint8_t));
+  }
+  port->bus_page = (status == 0) ? page : IS31FL3733_PAGE_UNKNOWN;
+  return status;
+}
+
+static void
+IS31FL3733_Sched_SendChunk (IS31FL3733_SCHED_PORT *port)
+{
+  IS31FL3733_SCHED_ENTRY *entry = IS31FL3733_Sched_Entry (port, 0);
+  uint8_t status = 0;
+  uint8_t count;
+  
+  // Select page on bus, if other page is selected.
+  if ((entry->page != IS31FL3733_SCHED_COMMON) && (entry->page != port->bus_page))
+  {
+    status = IS31FL3733_Sched_SelectPage (port, entry->page);
+  }
+  // Send next part of write.
+  count = entry->count - entry->sent;
+  if (count > IS31FL3733_SCHED_CHUNK)
+  {
+    count = IS31FL3733_SCHED_CHUNK;
+  }
+  if (status == 0)
+  {
+    status = IS31FL3733_Sched_Send (port->sched, port->device->address, entry->reg_addr + entry->sent, &port->data[entry->offset + entry->sent], count);
+  }
+  // Report failure to device: status, page selected again by driver and stale registers written by IS31FL3733_Resync.
+  if (status != 0)
+  {
+    IS31FL3733_KeepStatus (port->device, status);
+    port->device->page = IS31FL3733_PAGE_UNKNOWN;
+    if (entry->page != IS31FL3733_SCHED_COMMON)
+    {
+      IS31FL3733_MarkStale (port->device, ((uint16_t)entry->page << 8) | (uint8_t)(entry->reg_addr + entry->sent), count);
+    }
+  }
+  entry->sent += count;
+  // Remove completed write.
+  if (entry->sent == entry->count)
+  {
+    port->head = (port->head + 1) % IS31FL3733_SCHED_ENTRIES;
+    port->count--;
+    // Release payload buffer and deadline with empty queue.
+    if (port->count == 0)
+    {
+      port->used = 0;
+      port->deadline = IS31FL3733_SCHED_NO_DEADLINE;
+    }
+  }
+}
+
+static void
+IS31FL3733_Sched_Enqueue (IS31FL3733_SCHED_PORT *port, uint8_t page, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  IS31FL3733_SCHED_ENTRY *entry;
+  uint8_t n;
+  
+  // Merge write to Page 0-2 registers into latest queued write of the same registers.
+  // Page 3 and common registers have side effects and are always sent, writes are not moved across them or other pages.
+  for (n = port->count; (page < IS31FL3733_GET_PAGE(IS31FL3733_CR)) && (n > 0); n--)
+  {
+    entry = IS31FL3733_Sched_Entry (port, n - 1);
+    if (entry->page != page)
+    {
+      break;
+    }
+    if ((reg_addr >= entry->reg_addr + entry->count) || (reg_addr + count <= entry->reg_addr))
+    {
+      continue;
+    }
+    if ((entry->sent == 0) && (reg_addr >= entry->reg_addr) && (reg_addr + count <= entry->reg_addr + entry->count))
+    {
+      memcpy (&port->data[entry->offset + reg_addr - entry->reg_addr], buffer, count);
+      port->sched->merged += count;
+      return;
+    }
+    // Partial overlap, keep order of writes.
+    break;
+  }
+  // Extend latest write, if registers and payload are adjacent.
+  if (port->count != 0)
+  {
+    entry = IS31FL3733_Sched_Entry (port, port->count - 1);
+    if ((entry->page == page) && (entry->reg_addr + entry->count == reg_addr) && (entry->offset + entry->count == port->used) &&
+        (entry->count + count <= 0xFF) && (port->used + count <= IS31FL3733_SCHED_DATA_SIZE))
+    {
+      memcpy (&port->data[port->used], buffer, count);
+      entry->count += count;
+      port->used += count;
+      return;
+    }
+  }
+  // Send queued writes, if there is no space for new write.
+  if ((port->count == IS31FL3733_SCHED_ENTRIES) || (port->used + count > IS31FL3733_SCHED_DATA_SIZE))
+  {
+    IS31FL3733_Sched_Flush (port);
+  }
+  // Queue new write.
+  entry = IS31FL3733_Sched_Entry (port, port->count);
+  entry->page = page;
+  entry->reg_addr = reg_addr;
+  entry->count = count;
+  entry->sent = 0;
+  entry->offset = port->used;
+  memcpy (&port->data[port->used], buffer, count);
+  port->used += count;
+  port->count++;
+}
+
+static uint8_t
+IS31FL3733_Sched_Write (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  IS31FL3733_SCHED_PORT *port = (IS31FL3733_SCHED_PORT *)transport;
+  
+  (void)i2c_addr;
+  // Scheduler selects pages itself when queued writes are sent.
+  if (reg_addr == IS31FL3733_PSWL)
+  {
+    return 0;
+  }
+  if (reg_addr == IS31FL3733_PSR)
+  {
+    port->page = buffer[0];
+    return 0;
+  }
+  IS31FL3733_Sched_Enqueue (port, (reg_addr >= IS31FL3733_IMR) ? IS31FL3733_SCHED_COMMON : port->page, reg_addr, buffer, count);
+  return 0;
+}
+
+static uint8_t
+IS31FL3733_Sched_Read (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  IS31FL3733_SCHED_PORT *port = (IS31FL3733_SCHED_PORT *)transport;
+  uint8_t status;
+  
+  // Read must see all queued writes.
+  IS31FL3733_Sched_Flush (port);
+  // Select page of paged register on bus.
+  if ((reg_addr < IS31FL3733_IMR) && (port->page != port->bus_page))
+  {
+    status = IS31FL3733_Sched_SelectPage (port, port->page);
+    if (status != 0)
+    {
+      return status;
+    }
+  }
+  status = port->sched->i2c_read_reg (i2c_addr, reg_addr, buffer, count);
+  // Reading RESET register resets page selection.
+  if ((port->page == IS31FL3733_GET_PAGE(IS31FL3733_RESET)) && (reg_addr == IS31FL3733_GET_ADDR(IS31FL3733_RESET)))
+  {
+    port->bus_page = IS31FL3733_PAGE_UNKNOWN;
+  }
+  return status;
+}
+
+void
+IS31FL3733_Sched_Init (IS31FL3733_SCHED *sched,
+                       uint8_t (*i2c_write_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count),
+                       uint8_t (*i2c_read_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count))
+{
+  sched->i2c_write_reg = i2c_write_reg;
+  sched->i2c_read_reg = i2c_read_reg;
+  sched->count = 0;
+  sched->next = 0;
+  sched->now = 0;
+  sched->merged = 0;
+  sched->status = 0;
+}
+
+IS31FL3733_SCHED_PORT *
+IS31FL3733_Sched_Attach (IS31FL3733_SCHED *sched, IS31FL3733 *device, uint8_t priority)
+{
+  IS31FL3733_SCHED_PORT *port;
+  
+  if (sched->count >= IS31FL3733_SCHED_DEVICES)
+  {
+    return NULL;
+  }
+  port = &sched->ports[sched->count++];
+  port->transport.write = &IS31FL3733_Sched_Write;
+  port->transport.read = &IS31FL3733_Sched_Read;
+  port->sched = sched;
+  port->device = device;
+  port->priority = priority;
+  port->deadline = IS31FL3733_SCHED_NO_DEADLINE;
+  port->page = IS31FL3733_PAGE_UNKNOWN;
+  port->bus_page = IS31FL3733_PAGE_UNKNOWN;
+  port->head = 0;
+  port->count = 0;
+  port->used = 0;
+  // Device selects page again through scheduler.
+  IS31FL3733_SetTransport (device, &port->transport);
+  return port;
+}
+
+void
+IS31FL3733_Sched_SetDeadline (IS31FL3733_SCHED_PORT *port, uint32_t deadline)
+{
+  port->deadline = deadline;
+}
+
+static uint8_t
+IS31FL3733_Sched_IsUrgent (IS31FL3733_SCHED *sched, IS31FL3733_SCHED_PORT *port, IS31FL3733_SCHED_PORT *best)
+{
+  // Higher priority first.
+  if (port->priority != best->priority)
+  {
+    return port->priority > best->priority;
+  }
+  // Earlier deadline first, ports without deadline last.
+  if (port->deadline == IS31FL3733_SCHED_NO_DEADLINE)
+  {
+    return 0;
+  }
+  if (best->deadline == IS31FL3733_SCHED_NO_DEADLINE)
+  {
+    return 1;
+  }
+  return (int32_t)(port->deadline - sched->now) < (int32_t)(best->deadline - sched->now);
+}
+
+uint8_t
+IS31FL3733_Sched_Step (IS31FL3733_SCHED *sched, uint32_t now)
+{
+  IS31FL3733_SCHED_PORT *best = NULL;
+  uint8_t best_index = 0;
+  uint8_t index;
+  uint8_t i;
+  
+  sched->now = now;
+  // Find the most urgent port with queued writes, starting from next port in round-robin order.
+  for (i = 0; i < sched->count; i++)
+  {
+    index = (sched->next + i) % sched->count;
+    if ((sched->ports[index].count != 0) && ((best == NULL) || IS31FL3733_Sched_IsUrgent (sched, &sched->ports[index], best)))
+    {
+      best = &sched->ports[index];
+      best_index = index;
+    }
+  }
+  if (best == NULL)
+  {
+    return 0;
+  }
+  IS31FL3733_Sched_SendChunk (best);
+  sched->next = (best_index + 1) % sched->count;
+  return 1;
+}
+
+void
+IS31FL3733_Sched_Run (IS31FL3733_SCHED *sched, uint32_t now)
+{
+  while (IS31FL3733_Sched_Step (sched, now));
+}
+
+void
+IS31FL3733_Sched_Flush (IS31FL3733_SCHED_PORT *port)
+{
+  while (port->count != 0)
+  {
+    IS31FL3733_Sched_SendChunk (port);
+  }
+}
+
+uint8_t
+IS31FL3733_Sched_GetStatus (IS31FL3733_SCHED *sched)
+{
+  uint8_t status = sched->status;
+  
+  sched->status = 0;
+  return status;
+}
@@ -0,0 +1,127 @@
+/** ISSI IS31FL3733 shared I2C bus scheduler.
+  * Scheduler owns I2C bus for all attached devices: their writes are queued per device,
+  * redundant writes to Page 0-2 registers are merged and queued bursts are sent in chunks
+  * interleaved between devices by priority, deadline and round-robin order.
+  * Writes fail after they are queued: status is kept in device for IS31FL3733_GetStatus
+  * and registers of failed chunk are marked stale for IS31FL3733_Resync.
+  */
+#ifndef _IS31FL3733_SCHED_H_
+#define _IS31FL3733_SCHED_H_
+
+#include "is31fl3733.h"
+
+/// Maximum number of devices on bus.
+#ifndef IS31FL3733_SCHED_DEVICES
+#define IS31FL3733_SCHED_DEVICES (4)
+#endif
+
+/// Maximum number of queued writes for each device.
+#ifndef IS31FL3733_SCHED_ENTRIES
+#define IS31FL3733_SCHED_ENTRIES (16)
+#endif
+
+/// Size of queued writes payload buffer for each device, bytes. Must fit longest write.
+#ifndef IS31FL3733_SCHED_DATA_SIZE
+#define IS31FL3733_SCHED_DATA_SIZE (256)
+#endif
+
+/// Maximum number of bytes sent to one device before other devices get the bus.
+#ifndef IS31FL3733_SCHED_CHUNK
+#define IS31FL3733_SCHED_CHUNK (32)
+#endif
+
+#if IS31FL3733_SCHED_DATA_SIZE < 255
+#error "IS31FL3733_SCHED_DATA_SIZE must fit longest write of 255 bytes"
+#endif
+
+/// Page of common registers in queued writes.
+#define IS31FL3733_SCHED_COMMON (0xFE)
+
+/// No deadline set.
+#define IS31FL3733_SCHED_NO_DEADLINE (0)
+
+/** Queued write.
+  */
+typedef struct {
+  /// Register page, IS31FL3733_SCHED_COMMON for common registers.
+  uint8_t page;
+  /// First register address.
+  uint8_t reg_addr;
+  /// Number of bytes to write.
+  uint8_t count;
+  /// Number of bytes already sent.
+  uint8_t sent;
+  /// Offset of payload in port data buffer.
+  uint16_t offset;
+} IS31FL3733_SCHED_ENTRY;
+
+typedef struct IS31FL3733_SCHED IS31FL3733_SCHED;
+
+/** Device port of scheduler.
+  */
+typedef struct {
+  /// Transport interface attached to device. Must be first member.
+  IS31FL3733_TRANSPORT transport;
+  /// Scheduler owning port.
+  IS31FL3733_SCHED *sched;
+  /// Device attached to port.
+  IS31FL3733 *device;
+  /// Port priority, ports with higher priority are served first.
+  uint8_t priority;
+  /// Time queued writes must be sent by, IS31FL3733_SCHED_NO_DEADLINE if not set. Cleared when queue is empty.
+  uint32_t deadline;
+  /// Page selected by device for next queued writes.
+  uint8_t page;
+  /// Page selected on bus.
+  uint8_t bus_page;
+  /// Index of oldest queued write.
+  uint8_t head;
+  /// Number of queued writes.
+  uint8_t count;
+  /// Number of used payload bytes.
+  uint16_t used;
+  /// Queued writes.
+  IS31FL3733_SCHED_ENTRY entries[IS31FL3733_SCHED_ENTRIES];
+  /// Payload of queued writes.
+  uint8_t data[IS31FL3733_SCHED_DATA_SIZE];
+} IS31FL3733_SCHED_PORT;
+
+/** Bus scheduler.
+  */
+struct IS31FL3733_SCHED {
+  /// Pointer to I2C write register function of shared bus.
+  uint8_t (*i2c_write_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+  /// Pointer to I2C read register function of shared bus.
+  uint8_t (*i2c_read_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+  /// Number of attached devices.
+  uint8_t count;
+  /// Port served first among ports with equal priority and deadline.
+  uint8_t next;
+  /// Current time for deadline comparison.
+  uint32_t now;
+  /// Number of queued bytes replaced by later writes to the same registers.
+  uint32_t merged;
+  /// First non-zero status returned by bus, cleared by IS31FL3733_Sched_GetStatus.
+  uint8_t status;
+  /// Device ports.
+  IS31FL3733_SCHED_PORT ports[IS31FL3733_SCHED_DEVICES];
+};
+
+/// Initialize scheduler for bus with blocking I2C functions.
+void IS31FL3733_Sched_Init (IS31FL3733_SCHED *sched,
+                            uint8_t (*i2c_write_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count),
+                            uint8_t (*i2c_read_reg) (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count));
+/// Attach device to scheduler as transport with priority. Returns port or NULL if all ports are used.
+IS31FL3733_SCHED_PORT *IS31FL3733_Sched_Attach (IS31FL3733_SCHED *sched, IS31FL3733 *device, uint8_t priority);
+/// Set time by which currently queued and following writes of port must be sent.
+void IS31FL3733_Sched_SetDeadline (IS31FL3733_SCHED_PORT *port, uint32_t deadline);
+/// Send one chunk of queued writes of the most urgent port. Returns 0 if all queues are empty.
+uint8_t IS31FL3733_Sched_Step (IS31FL3733_SCHED *sched, uint32_t now);
+/// Send all queued writes, interleaving ports.
+void IS31FL3733_Sched_Run (IS31FL3733_SCHED *sched, uint32_t now);
+/// Send all queued writes of one port.
+void IS31FL3733_Sched_Flush (IS31FL3733_SCHED_PORT *port);
+/// Get and clear first error status returned by bus.
+uint8_t IS31FL3733_Sched_GetStatus (IS31FL3733_SCHED *sched);
+
+#endif /* _IS31FL3733_SCHED_H_ */
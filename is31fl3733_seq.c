@@ -0,0 +1,384 @@
+#include "is31fl3733_seq.h"
+
+#include <string.h>
+
+/// Longest skip, literal and run operations.
+#define IS31FL3733_SEQ_SKIP_MAX    (0x80)
+#define IS31FL3733_SEQ_LITERAL_MAX (0x40)
+#define IS31FL3733_SEQ_RUN_MAX     (0x40)
+
+static uint16_t
+IS31FL3733_Seq_Get16 (const uint8_t *data)
+{
+  return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+static uint32_t
+IS31FL3733_Seq_Get32 (const uint8_t *data)
+{
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void
+IS31FL3733_Seq_Put16 (uint8_t *data, uint16_t value)
+{
+  data[0] = (uint8_t)value;
+  data[1] = (uint8_t)(value >> 8);
+}
+
+static void
+IS31FL3733_Seq_Put32 (uint8_t *data, uint32_t value)
+{
+  IS31FL3733_Seq_Put16 (data, (uint16_t)value);
+  IS31FL3733_Seq_Put16 (data + 2, (uint16_t)(value >> 16));
+}
+
+static void
+IS31FL3733_Seq_Store (IS31FL3733 *device, uint8_t *leds, uint8_t section, uint8_t i, uint8_t value)
+{
+  switch (section)
+  {
+    case IS31FL3733_SEQ_FRAME_PWM:
+      IS31FL3733_UpdateLEDPWM (device, i % IS31FL3733_CS, i / IS31FL3733_CS, value);
+      break;
+    case IS31FL3733_SEQ_FRAME_STATE:
+      leds[i] = value;
+      break;
+    default:
+      IS31FL3733_UpdateLEDMode (device, i % IS31FL3733_CS, i / IS31FL3733_CS, (IS31FL3733_LED_MODE)value);
+      break;
+  }
+}
+
+static const uint8_t *
+IS31FL3733_Seq_DecodeSection (IS31FL3733 *device, uint8_t *leds, uint8_t section, uint16_t length, const uint8_t *data, const uint8_t *end)
+{
+  uint16_t i = 0;
+  uint8_t op;
+  uint8_t n;
+  uint8_t j;
+  
+  while (i < length)
+  {
+    if (data >= end)
+    {
+      return NULL;
+    }
+    op = *data++;
+    if (op < IS31FL3733_SEQ_OP_LITERAL)
+    {
+      // Keep unchanged registers.
+      n = op - IS31FL3733_SEQ_OP_SKIP + 1;
+    }
+    else if (op < IS31FL3733_SEQ_OP_RUN)
+    {
+      // Copy new values.
+      n = op - IS31FL3733_SEQ_OP_LITERAL + 1;
+      if ((end - data < n) || (i + n > length))
+      {
+        return NULL;
+      }
+      for (j = 0; j < n; j++)
+      {
+        IS31FL3733_Seq_Store (device, leds, section, (uint8_t)(i + j), data[j]);
+      }
+      data += n;
+    }
+    else
+    {
+      // Repeat one value.
+      n = op - IS31FL3733_SEQ_OP_RUN + 1;
+      if ((data >= end) || (i + n > length))
+      {
+        return NULL;
+      }
+      for (j = 0; j < n; j++)
+      {
+        IS31FL3733_Seq_Store (device, leds, section, (uint8_t)(i + j), *data);
+      }
+      data++;
+    }
+    i += n;
+  }
+  // Operations must end exactly at section end.
+  return (i == length) ? data : NULL;
+}
+
+static uint8_t
+IS31FL3733_Seq_DecodeFrame (IS31FL3733_SEQ_PLAYER *player, uint8_t *leds)
+{
+  const uint8_t *data;
+  const uint8_t *end;
+  uint8_t flags;
+  
+  // Check frame header and payload are inside sequence.
+  if ((player->offset > player->size) || (player->size - player->offset < IS31FL3733_SEQ_FRAME_HEADER_SIZE))
+  {
+    return IS31FL3733_SEQ_ERROR;
+  }
+  data = &player->data[player->offset];
+  flags = data[0];
+  end = data + IS31FL3733_SEQ_FRAME_HEADER_SIZE + IS31FL3733_Seq_Get16 (&data[1]);
+  if ((uint32_t)(end - player->data) > player->size)
+  {
+    return IS31FL3733_SEQ_ERROR;
+  }
+  data += IS31FL3733_SEQ_FRAME_HEADER_SIZE;
+  // Decode sections directly to shadow buffers.
+  if (flags & IS31FL3733_SEQ_FRAME_PWM)
+  {
+    data = IS31FL3733_Seq_DecodeSection (player->device, leds, IS31FL3733_SEQ_FRAME_PWM, IS31FL3733_SW * IS31FL3733_CS, data, end);
+  }
+  if ((data != NULL) && (flags & IS31FL3733_SEQ_FRAME_STATE))
+  {
+    data = IS31FL3733_Seq_DecodeSection (player->device, leds, IS31FL3733_SEQ_FRAME_STATE, IS31FL3733_SW * IS31FL3733_CS / 8, data, end);
+  }
+  if ((data != NULL) && (flags & IS31FL3733_SEQ_FRAME_MODE))
+  {
+    data = IS31FL3733_Seq_DecodeSection (player->device, leds, IS31FL3733_SEQ_FRAME_MODE, IS31FL3733_SW * IS31FL3733_CS, data, end);
+  }
+  if (data == NULL)
+  {
+    return IS31FL3733_SEQ_ERROR;
+  }
+  player->offset = (uint32_t)(end - player->data);
+  player->frame++;
+  return IS31FL3733_SEQ_FRAME;
+}
+
+static void
+IS31FL3733_Seq_Write (IS31FL3733_SEQ_PLAYER *player, uint8_t *leds)
+{
+  // Write changed PWM and mode registers, then changed LED states.
+  IS31FL3733_Flush (player->device);
+  IS31FL3733_SetStatePacked (player->device, leds);
+}
+
+uint8_t
+IS31FL3733_Seq_Open (IS31FL3733_SEQ_PLAYER *player, IS31FL3733 *device, const uint8_t *data, uint32_t size)
+{
+  // Check header, frame period must be set.
+  if ((size < IS31FL3733_SEQ_HEADER_SIZE) || (memcmp (data, "I3SQ", 4) != 0) || (data[4] != IS31FL3733_SEQ_VERSION) ||
+      (IS31FL3733_Seq_Get16 (&data[6]) == 0))
+  {
+    return IS31FL3733_SEQ_ERROR;
+  }
+  player->device = device;
+  player->data = data;
+  player->size = size;
+  player->period = IS31FL3733_Seq_Get16 (&data[6]);
+  player->count = IS31FL3733_Seq_Get16 (&data[8]);
+  player->keyframes = IS31FL3733_Seq_Get16 (&data[10]);
+  player->index = IS31FL3733_Seq_Get32 (&data[12]);
+  // Check keyframe index is inside sequence.
+  if ((player->index > size) || ((size - player->index) / IS31FL3733_SEQ_INDEX_SIZE < player->keyframes))
+  {
+    return IS31FL3733_SEQ_ERROR;
+  }
+  player->frame = 0;
+  player->offset = IS31FL3733_SEQ_HEADER_SIZE;
+  player->time = 0;
+  player->loop = 0;
+  return 0;
+}
+
+IS31FL3733_SEQ_STATUS
+IS31FL3733_Seq_Seek (IS31FL3733_SEQ_PLAYER *player, uint16_t frame, uint32_t now)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  const uint8_t *entry;
+  uint16_t i;
+  
+  if (frame >= player->count)
+  {
+    return IS31FL3733_SEQ_ERROR;
+  }
+  // Find nearest keyframe before requested frame, sequence starts with keyframe.
+  player->frame = 0;
+  player->offset = IS31FL3733_SEQ_HEADER_SIZE;
+  for (i = 0; i < player->keyframes; i++)
+  {
+    entry = &player->data[player->index + i * IS31FL3733_SEQ_INDEX_SIZE];
+    if (IS31FL3733_Seq_Get16 (entry) > frame)
+    {
+      break;
+    }
+    player->frame = IS31FL3733_Seq_Get16 (entry);
+    player->offset = IS31FL3733_Seq_Get32 (&entry[2]);
+  }
+  // Decode frames up to requested frame and write result once.
+  memcpy (leds, player->device->leds, sizeof(leds));
+  while (player->frame <= frame)
+  {
+    if (IS31FL3733_Seq_DecodeFrame (player, leds) != IS31FL3733_SEQ_FRAME)
+    {
+      return IS31FL3733_SEQ_ERROR;
+    }
+  }
+  IS31FL3733_Seq_Write (player, leds);
+  player->time = now + player->period;
+  return IS31FL3733_SEQ_FRAME;
+}
+
+IS31FL3733_SEQ_STATUS
+IS31FL3733_Seq_Play (IS31FL3733_SEQ_PLAYER *player, uint32_t now)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint16_t decoded = 0;
+  
+  memcpy (leds, player->device->leds, sizeof(leds));
+  // Decode all frames due at this time, late frames are not written separately.
+  while ((int32_t)(now - player->time) >= 0)
+  {
+    if (player->frame >= player->count)
+    {
+      if (!player->loop)
+      {
+        break;
+      }
+      // Restart from first frame, it is keyframe.
+      player->frame = 0;
+      player->offset = IS31FL3733_SEQ_HEADER_SIZE;
+    }
+    if (IS31FL3733_Seq_DecodeFrame (player, leds) != IS31FL3733_SEQ_FRAME)
+    {
+      return IS31FL3733_SEQ_ERROR;
+    }
+    // Next frame time doesn't depend on call time to keep frame rate.
+    player->time += player->period;
+    // Resynchronize if player was stalled for whole sequence.
+    if (++decoded >= player->count)
+    {
+      player->time = now + player->period;
+    }
+  }
+  if (decoded != 0)
+  {
+    IS31FL3733_Seq_Write (player, leds);
+    return IS31FL3733_SEQ_FRAME;
+  }
+  return (player->frame >= player->count) ? IS31FL3733_SEQ_END : IS31FL3733_SEQ_WAIT;
+}
+
+void
+IS31FL3733_Seq_EncodeHeader (uint8_t *out, uint16_t period, uint16_t count, uint16_t keyframes, uint32_t index)
+{
+  memcpy (out, "I3SQ", 4);
+  out[4] = IS31FL3733_SEQ_VERSION;
+  out[5] = 0;
+  IS31FL3733_Seq_Put16 (&out[6], period);
+  IS31FL3733_Seq_Put16 (&out[8], count);
+  IS31FL3733_Seq_Put16 (&out[10], keyframes);
+  IS31FL3733_Seq_Put32 (&out[12], index);
+}
+
+static uint16_t
+IS31FL3733_Seq_EncodeSection (uint8_t *out, uint16_t capacity, const uint8_t *values, const uint8_t *prev, uint16_t length)
+{
+  uint16_t size = 0;
+  uint16_t i = 0;
+  uint16_t n;
+  
+  while (i < length)
+  {
+    // Skip unchanged registers.
+    for (n = 0; (prev != NULL) && (i + n < length) && (n < IS31FL3733_SEQ_SKIP_MAX) && (values[i + n] == prev[i + n]); n++);
+    if (n != 0)
+    {
+      if (capacity - size < 1)
+      {
+        return 0;
+      }
+      out[size++] = (uint8_t)(IS31FL3733_SEQ_OP_SKIP + n - 1);
+      i += n;
+      continue;
+    }
+    // Repeat value, if it is repeated 3 or more times.
+    for (n = 1; (i + n < length) && (n < IS31FL3733_SEQ_RUN_MAX) && (values[i + n] == values[i]); n++);
+    if (n >= 3)
+    {
+      if (capacity - size < 2)
+      {
+        return 0;
+      }
+      out[size++] = (uint8_t)(IS31FL3733_SEQ_OP_RUN + n - 1);
+      out[size++] = values[i];
+      i += n;
+      continue;
+    }
+    // Copy changed values until unchanged register or run.
+    for (n = 1; (i + n < length) && (n < IS31FL3733_SEQ_LITERAL_MAX); n++)
+    {
+      if (((prev != NULL) && (values[i + n] == prev[i + n])) ||
+          ((i + n + 2 < length) && (values[i + n] == values[i + n + 1]) && (values[i + n] == values[i + n + 2])))
+      {
+        break;
+      }
+    }
+    if (capacity - size < n + 1)
+    {
+      return 0;
+    }
+    out[size++] = (uint8_t)(IS31FL3733_SEQ_OP_LITERAL + n - 1);
+    memcpy (&out[size], &values[i], n);
+    size += n;
+    i += n;
+  }
+  return size;
+}
+
+static uint8_t
+IS31FL3733_Seq_AppendSection (uint8_t *out, uint16_t capacity, uint16_t *size, const uint8_t *values, const uint8_t *prev, uint16_t length)
+{
+  uint16_t section;
+  
+  // Section is never empty, zero size means it doesn't fit into buffer.
+  section = IS31FL3733_Seq_EncodeSection (&out[*size], capacity - *size, values, prev, length);
+  *size += section;
+  return section != 0;
+}
+
+uint16_t
+IS31FL3733_Seq_EncodeFrame (uint8_t *out, uint16_t capacity, const uint8_t *pwm, const uint8_t *prev_pwm, const uint8_t *leds,
+                            const uint8_t *prev_leds, const uint8_t *modes, const uint8_t *prev_modes)
+{
+  uint16_t size = IS31FL3733_SEQ_FRAME_HEADER_SIZE;
+  uint8_t flags = 0;
+  
+  if (capacity < size)
+  {
+    return 0;
+  }
+  // Keyframe encodes full registers, delta frame encodes only changed sections.
+  if ((prev_pwm == NULL) && (prev_leds == NULL) && (prev_modes == NULL))
+  {
+    flags |= IS31FL3733_SEQ_FRAME_KEY;
+  }
+  if ((pwm != NULL) && ((prev_pwm == NULL) || (memcmp (pwm, prev_pwm, IS31FL3733_SW * IS31FL3733_CS) != 0)))
+  {
+    flags |= IS31FL3733_SEQ_FRAME_PWM;
+    if (!IS31FL3733_Seq_AppendSection (out, capacity, &size, pwm, prev_pwm, IS31FL3733_SW * IS31FL3733_CS))
+    {
+      return 0;
+    }
+  }
+  if ((leds != NULL) && ((prev_leds == NULL) || (memcmp (leds, prev_leds, IS31FL3733_SW * IS31FL3733_CS / 8) != 0)))
+  {
+    flags |= IS31FL3733_SEQ_FRAME_STATE;
+    if (!IS31FL3733_Seq_AppendSection (out, capacity, &size, leds, prev_leds, IS31FL3733_SW * IS31FL3733_CS / 8))
+    {
+      return 0;
+    }
+  }
+  if ((modes != NULL) && ((prev_modes == NULL) || (memcmp (modes, prev_modes, IS31FL3733_SW * IS31FL3733_CS) != 0)))
+  {
+    flags |= IS31FL3733_SEQ_FRAME_MODE;
+    if (!IS31FL3733_Seq_AppendSection (out, capacity, &size, modes, prev_modes, IS31FL3733_SW * IS31FL3733_CS))
+    {
+      return 0;
+    }
+  }
+  out[0] = flags;
+  IS31FL3733_Seq_Put16 (&out[1], size - IS31FL3733_SEQ_FRAME_HEADER_SIZE);
+  return size;
+}
@@ -0,0 +1,97 @@
+/** ISSI IS31FL3733 delta-encoded frame sequence format and player.
+  *
+  * Sequence layout, all numbers little-endian:
+  *   Header, IS31FL3733_SEQ_HEADER_SIZE bytes:
+  *     "I3SQ", version, reserved, frame period in ms (2 bytes), number of frames (2 bytes),
+  *     number of keyframes (2 bytes), offset of keyframe index (4 bytes).
+  *   Frames, each is flags byte, payload size (2 bytes) and payload with sections set in flags:
+  *     PWM (192 registers), LED ON/OFF (24 registers in LEDONOFF layout), LED mode (192 registers).
+  *   Keyframe index, IS31FL3733_SEQ_INDEX_SIZE bytes per keyframe: frame number (2 bytes), frame offset (4 bytes).
+  *
+  * Section is a list of operations covering all its registers against previous frame:
+  *   0x00-0x7F: skip (op + 1) unchanged registers;
+  *   0x80-0xBF: (op - 0x7F) new values follow;
+  *   0xC0-0xFF: (op - 0xBF) registers set to value in next byte.
+  * Keyframe sections don't skip registers, so keyframe decodes without previous frames.
+  */
+#ifndef _IS31FL3733_SEQ_H_
+#define _IS31FL3733_SEQ_H_
+
+#include "is31fl3733_abm.h"
+
+/// Sequence format version.
+#define IS31FL3733_SEQ_VERSION (1)
+
+/// Size of sequence header, bytes.
+#define IS31FL3733_SEQ_HEADER_SIZE (16)
+/// Size of frame header, bytes.
+#define IS31FL3733_SEQ_FRAME_HEADER_SIZE (3)
+/// Size of keyframe index entry, bytes.
+#define IS31FL3733_SEQ_INDEX_SIZE (6)
+/// Maximum size of encoded section of length registers. Worst case alternates changed and unchanged registers:
+/// one byte literal and one byte skip operations take 3 bytes per 2 registers.
+#define IS31FL3733_SEQ_SECTION_MAX(length) (((length) * 3 + 1) / 2)
+/// Maximum size of encoded frame: frame header and worst case of all sections.
+#define IS31FL3733_SEQ_FRAME_MAX (IS31FL3733_SEQ_FRAME_HEADER_SIZE + 2 * IS31FL3733_SEQ_SECTION_MAX(IS31FL3733_SW * IS31FL3733_CS) + \
+                                  IS31FL3733_SEQ_SECTION_MAX(IS31FL3733_SW * IS31FL3733_CS / 8))
+
+/// Frame flags.
+#define IS31FL3733_SEQ_FRAME_KEY   (0x01) /// Frame decodes without previous frames.
+#define IS31FL3733_SEQ_FRAME_PWM   (0x02) /// Frame has PWM section.
+#define IS31FL3733_SEQ_FRAME_STATE (0x04) /// Frame has LED ON/OFF section.
+#define IS31FL3733_SEQ_FRAME_MODE  (0x08) /// Frame has LED mode section.
+
+/// Section operations.
+#define IS31FL3733_SEQ_OP_SKIP    (0x00) /// Skip unchanged registers.
+#define IS31FL3733_SEQ_OP_LITERAL (0x80) /// Copy new values.
+#define IS31FL3733_SEQ_OP_RUN     (0xC0) /// Repeat one value.
+
+/// Player status.
+typedef enum {
+  IS31FL3733_SEQ_WAIT  = 0x00, ///< Frame time is not reached yet.
+  IS31FL3733_SEQ_FRAME = 0x01, ///< Frame was written to device.
+  IS31FL3733_SEQ_END   = 0x02, ///< Last frame was played.
+  IS31FL3733_SEQ_ERROR = 0x03  ///< Sequence data is malformed.
+} IS31FL3733_SEQ_STATUS;
+
+/** Sequence player. Reads frames directly from memory-mapped sequence.
+  */
+typedef struct {
+  /// Pointer to device.
+  IS31FL3733 *device;
+  /// Sequence data in flash or memory-mapped file.
+  const uint8_t *data;
+  /// Size of sequence data.
+  uint32_t size;
+  /// Frame period, ms.
+  uint16_t period;
+  /// Number of frames.
+  uint16_t count;
+  /// Number of keyframes.
+  uint16_t keyframes;
+  /// Offset of keyframe index.
+  uint32_t index;
+  /// Number of next frame.
+  uint16_t frame;
+  /// Offset of next frame.
+  uint32_t offset;
+  /// Time to show next frame, ms.
+  uint32_t time;
+  /// Restart sequence after last frame.
+  uint8_t loop;
+} IS31FL3733_SEQ_PLAYER;
+
+/// Open sequence for device. Returns 0 on success, IS31FL3733_SEQ_ERROR on malformed header. Start playback with IS31FL3733_Seq_Seek.
+uint8_t IS31FL3733_Seq_Open (IS31FL3733_SEQ_PLAYER *player, IS31FL3733 *device, const uint8_t *data, uint32_t size);
+/// Decode frames from nearest keyframe to requested frame, write changed registers and schedule next frame after time now.
+IS31FL3733_SEQ_STATUS IS31FL3733_Seq_Seek (IS31FL3733_SEQ_PLAYER *player, uint16_t frame, uint32_t now);
+/// Show frames due at time now, late frames are decoded and written together.
+IS31FL3733_SEQ_STATUS IS31FL3733_Seq_Play (IS31FL3733_SEQ_PLAYER *player, uint32_t now);
+/// Write sequence header. Keyframe index follows frames at index offset.
+void IS31FL3733_Seq_EncodeHeader (uint8_t *out, uint16_t period, uint16_t count, uint16_t keyframes, uint32_t index);
+/// Encode frame against previous frame to out buffer of capacity bytes, NULL previous buffers encode keyframe. Sections with NULL current buffer
+/// are omitted. Returns frame size, 0 if frame doesn't fit into buffer. Buffer of IS31FL3733_SEQ_FRAME_MAX bytes fits any frame.
+uint16_t IS31FL3733_Seq_EncodeFrame (uint8_t *out, uint16_t capacity, const uint8_t *pwm, const uint8_t *prev_pwm, const uint8_t *leds,
+                                     const uint8_t *prev_leds, const uint8_t *modes, const uint8_t *prev_modes);
+
+#endif /* _IS31FL3733_SEQ_H_ */
@@ -0,0 +1,345 @@
+#include "is31fl3733_sim.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/// Simulated bus used by IS31FL3733_Sim_I2C* functions.
+static IS31FL3733_SIM *IS31FL3733_Sim_Selected;
+
+static void
+IS31FL3733_Sim_Reset (IS31FL3733_SIM_DEVICE *device)
+{
+  // Set all registers to power-on values, injected faults are kept.
+  device->pswl = IS31FL3733_PSWL_DISABLE;
+  device->psr = 0;
+  device->imr = 0;
+  device->isr = 0;
+  memset (device->pages, 0, sizeof(device->pages));
+}
+
+static void
+IS31FL3733_Sim_DetectLEDs (IS31FL3733_SIM_DEVICE *device)
+{
+  uint8_t i;
+  uint8_t open = 0;
+  uint8_t shorted = 0;
+  
+  // Only LEDs turned on are checked.
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS / 8; i++)
+  {
+    device->pages[0][IS31FL3733_GET_ADDR(IS31FL3733_LEDOPEN) + i] = device->open[i] & device->pages[0][i];
+    device->pages[0][IS31FL3733_GET_ADDR(IS31FL3733_LEDSHORT) + i] = device->shorted[i] & device->pages[0][i];
+    open |= device->open[i] & device->pages[0][i];
+    shorted |= device->shorted[i] & device->pages[0][i];
+  }
+  // Set interrupt status for enabled interrupts.
+  if (open && (device->imr & IS31FL3733_IMR_IO))
+  {
+    device->isr |= IS31FL3733_ISR_OB;
+  }
+  if (shorted && (device->imr & IS31FL3733_IMR_IS))
+  {
+    device->isr |= IS31FL3733_ISR_SB;
+  }
+}
+
+static uint8_t
+IS31FL3733_Sim_IsWritable (uint8_t page, uint8_t reg_addr)
+{
+  switch (page)
+  {
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDONOFF):
+      // LED open and short registers are read only.
+      return reg_addr < IS31FL3733_GET_ADDR(IS31FL3733_LEDOPEN);
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDPWM):
+    case IS31FL3733_GET_PAGE(IS31FL3733_LEDABM):
+      return reg_addr < IS31FL3733_SW * IS31FL3733_CS;
+    case IS31FL3733_GET_PAGE(IS31FL3733_CR):
+      // Reset register is read only.
+      return reg_addr < IS31FL3733_GET_ADDR(IS31FL3733_RESET);
+    default:
+      return 0;
+  }
+}
+
+static void
+IS31FL3733_Sim_WriteReg (IS31FL3733_SIM_DEVICE *device, uint8_t reg_addr, uint8_t reg_value)
+{
+  uint8_t old;
+  
+  switch (reg_addr)
+  {
+    case IS31FL3733_PSWL:
+      device->pswl = reg_value;
+      break;
+    case IS31FL3733_PSR:
+      // Page select is accepted only when unlocked, lock is restored after write.
+      if ((device->pswl == IS31FL3733_PSWL_ENABLE) && (reg_value <= IS31FL3733_GET_PAGE(IS31FL3733_CR)))
+      {
+        device->psr = reg_value;
+      }
+      device->pswl = IS31FL3733_PSWL_DISABLE;
+      break;
+    case IS31FL3733_IMR:
+      device->imr = reg_value;
+      break;
+    case IS31FL3733_ISR:
+      // Read only register.
+      break;
+    default:
+      if (IS31FL3733_Sim_IsWritable (device->psr, reg_addr))
+      {
+        old = device->pages[device->psr][reg_addr];
+        device->pages[device->psr][reg_addr] = reg_value;
+        // Rising edge of OSD bit starts open/short detection.
+        if ((device->psr == IS31FL3733_GET_PAGE(IS31FL3733_CR)) && (reg_addr == IS31FL3733_GET_ADDR(IS31FL3733_CR)) &&
+            (reg_value & IS31FL3733_CR_OSD) && !(old & IS31FL3733_CR_OSD))
+        {
+          IS31FL3733_Sim_DetectLEDs (device);
+        }
+      }
+      break;
+  }
+}
+
+static uint8_t
+IS31FL3733_Sim_ReadReg (IS31FL3733_SIM_DEVICE *device, uint8_t reg_addr)
+{
+  uint8_t reg_value;
+  
+  switch (reg_addr)
+  {
+    case IS31FL3733_PSWL:
+      return device->pswl;
+    case IS31FL3733_ISR:
+      // Interrupt status is cleared on read.
+      reg_value = device->isr;
+      device->isr = 0;
+      return reg_value;
+    case IS31FL3733_PSR:
+    case IS31FL3733_IMR:
+      // Write only registers.
+      return 0;
+    default:
+      break;
+  }
+  if (device->psr == IS31FL3733_GET_PAGE(IS31FL3733_LEDOPEN))
+  {
+    // Only open and short registers are readable in Page 0.
+    if ((reg_addr >= IS31FL3733_GET_ADDR(IS31FL3733_LEDOPEN)) &&
+        (reg_addr < IS31FL3733_GET_ADDR(IS31FL3733_LEDSHORT) + IS31FL3733_SW * IS31FL3733_CS / 8))
+    {
+      return device->pages[0][reg_addr];
+    }
+  }
+  else if ((device->psr == IS31FL3733_GET_PAGE(IS31FL3733_RESET)) && (reg_addr == IS31FL3733_GET_ADDR(IS31FL3733_RESET)))
+  {
+    // Read of reset register resets device.
+    IS31FL3733_Sim_Reset (device);
+  }
+  return 0;
+}
+
+static uint8_t
+IS31FL3733_Sim_Transfer (IS31FL3733_SIM *sim, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count, uint8_t read)
+{
+  IS31FL3733_SIM_DEVICE *device;
+  IS31FL3733_SIM_RECORD *record;
+  uint32_t bits;
+  uint8_t i;
+  
+  record = &sim->log[sim->transactions % IS31FL3733_SIM_LOG_SIZE];
+  device = IS31FL3733_Sim_GetDevice (sim, i2c_addr);
+  record->i2c_addr = i2c_addr;
+  record->read = read;
+  record->page = (device != NULL) ? device->psr : 0;
+  record->reg_addr = reg_addr;
+  record->count = count;
+  if (device == NULL)
+  {
+    // Address is not acknowledged: START, address byte and STOP.
+    record->status = IS31FL3733_SIM_NACK;
+    bits = 1 + 9 + 1;
+    sim->bytes += 1;
+  }
+  else
+  {
+    record->status = 0;
+    for (i = 0; i < count; i++)
+    {
+      if (read)
+      {
+        buffer[i] = IS31FL3733_Sim_ReadReg (device, reg_addr + i);
+      }
+      else
+      {
+        IS31FL3733_Sim_WriteReg (device, reg_addr + i, buffer[i]);
+      }
+    }
+    if (read)
+    {
+      // START, address, register, repeated START, address, data and STOP.
+      bits = 1 + 9 + 9 + 1 + 9 + 9 * count + 1;
+      sim->bytes += 3 + count;
+    }
+    else
+    {
+      // START, address, register, data and STOP.
+      bits = 1 + 9 + 9 + 9 * count + 1;
+      sim->bytes += 2 + count;
+    }
+  }
+  memcpy (record->data, buffer, (count < IS31FL3733_SIM_LOG_DATA) ? count : IS31FL3733_SIM_LOG_DATA);
+  record->time = (uint32_t)((uint64_t)bits * 1000000000 / sim->clock);
+  sim->time += record->time;
+  sim->transactions++;
+  if (sim->on_transaction != NULL)
+  {
+    sim->on_transaction (sim, record, buffer);
+  }
+  return record->status;
+}
+
+static uint8_t
+IS31FL3733_Sim_Write (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  return IS31FL3733_Sim_Transfer ((IS31FL3733_SIM *)transport, i2c_addr, reg_addr, buffer, count, 0);
+}
+
+static uint8_t
+IS31FL3733_Sim_Read (IS31FL3733_TRANSPORT *transport, uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  return IS31FL3733_Sim_Transfer ((IS31FL3733_SIM *)transport, i2c_addr, reg_addr, buffer, count, 1);
+}
+
+void
+IS31FL3733_Sim_Init (IS31FL3733_SIM *sim, uint32_t clock)
+{
+  sim->transport.write = &IS31FL3733_Sim_Write;
+  sim->transport.read = &IS31FL3733_Sim_Read;
+  sim->clock = clock;
+  sim->count = 0;
+  sim->on_transaction = NULL;
+  IS31FL3733_Sim_ResetStats (sim);
+  IS31FL3733_Sim_Select (sim);
+}
+
+void
+IS31FL3733_Sim_Select (IS31FL3733_SIM *sim)
+{
+  IS31FL3733_Sim_Selected = sim;
+}
+
+IS31FL3733_SIM_DEVICE *
+IS31FL3733_Sim_AddDevice (IS31FL3733_SIM *sim, uint8_t address)
+{
+  IS31FL3733_SIM_DEVICE *device;
+  
+  if (sim->count >= IS31FL3733_SIM_DEVICES)
+  {
+    return NULL;
+  }
+  device = &sim->devices[sim->count++];
+  device->address = address;
+  memset (device->open, 0, sizeof(device->open));
+  memset (device->shorted, 0, sizeof(device->shorted));
+  IS31FL3733_Sim_Reset (device);
+  return device;
+}
+
+IS31FL3733_SIM_DEVICE *
+IS31FL3733_Sim_GetDevice (IS31FL3733_SIM *sim, uint8_t address)
+{
+  uint8_t i;
+  
+  for (i = 0; i < sim->count; i++)
+  {
+    if (sim->devices[i].address == address)
+    {
+      return &sim->devices[i];
+    }
+  }
+  return NULL;
+}
+
+void
+IS31FL3733_Sim_Attach (IS31FL3733_SIM *sim, IS31FL3733 *device)
+{
+  IS31FL3733_SetTransport (device, &sim->transport);
+}
+
+void
+IS31FL3733_Sim_ResetStats (IS31FL3733_SIM *sim)
+{
+  sim->transactions = 0;
+  sim->bytes = 0;
+  sim->time = 0;
+}
+
+IS31FL3733_SIM_RECORD *
+IS31FL3733_Sim_GetRecord (IS31FL3733_SIM *sim, uint32_t n)
+{
+  uint32_t first;
+  
+  // Find the oldest record kept in log.
+  first = (sim->transactions > IS31FL3733_SIM_LOG_SIZE) ? sim->transactions - IS31FL3733_SIM_LOG_SIZE : 0;
+  if (first + n >= sim->transactions)
+  {
+    return NULL;
+  }
+  return &sim->log[(first + n) % IS31FL3733_SIM_LOG_SIZE];
+}
+
+void
+IS31FL3733_Sim_SetLEDStatus (IS31FL3733_SIM_DEVICE *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_STATUS status)
+{
+  uint8_t offset;
+  uint8_t mask;
+  
+  // Check CS and SW boundaries.
+  if ((cs < IS31FL3733_CS) && (sw < IS31FL3733_SW))
+  {
+    // Calculate LED bit offset.
+    offset = (sw << 1) + (cs / 8);
+    mask = 0x01 << (cs % 8);
+    device->open[offset] &= ~mask;
+    device->shorted[offset] &= ~mask;
+    if (status == IS31FL3733_LED_STATUS_OPEN)
+    {
+      device->open[offset] |= mask;
+    }
+    else if (status == IS31FL3733_LED_STATUS_SHORT)
+    {
+      device->shorted[offset] |= mask;
+    }
+  }
+}
+
+void
+IS31FL3733_Sim_FinishABM (IS31FL3733_SIM_DEVICE *device, uint8_t n)
+{
+  // Set ABM finish bit, if auto breath interrupt is enabled.
+  if ((n >= 1) && (n <= 3) && (device->imr & IS31FL3733_IMR_IAB))
+  {
+    device->isr |= IS31FL3733_ISR_ABM1 << (n - 1);
+  }
+}
+
+uint8_t
+IS31FL3733_Sim_GetINTB (IS31FL3733_SIM_DEVICE *device)
+{
+  // INTB is open drain output pulled low while interrupt status is set.
+  return device->isr == 0;
+}
+
+uint8_t
+IS31FL3733_Sim_I2CWriteReg (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  return IS31FL3733_Sim_Transfer (IS31FL3733_Sim_Selected, i2c_addr, reg_addr, buffer, count, 0);
+}
+
+uint8_t
+IS31FL3733_Sim_I2CReadReg (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  return IS31FL3733_Sim_Transfer (IS31FL3733_Sim_Selected, i2c_addr, reg_addr, buffer, count, 1);
+}
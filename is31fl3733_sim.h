@@ -0,0 +1,118 @@
+/** ISSI IS31FL3733 software simulator for host testing.
+  */
+#ifndef _IS31FL3733_SIM_H_
+#define _IS31FL3733_SIM_H_
+
+#include "is31fl3733.h"
+
+/// Maximum number of simulated devices on bus.
+#define IS31FL3733_SIM_DEVICES (16)
+
+/// Number of transaction records kept in log.
+#ifndef IS31FL3733_SIM_LOG_SIZE
+#define IS31FL3733_SIM_LOG_SIZE (256)
+#endif
+
+/// Number of payload bytes kept in transaction record.
+#ifndef IS31FL3733_SIM_LOG_DATA
+#define IS31FL3733_SIM_LOG_DATA (16)
+#endif
+
+/// Number of registers in each simulated page.
+#define IS31FL3733_SIM_PAGE_SIZE (IS31FL3733_SW * IS31FL3733_CS)
+
+/// Status returned by simulator when no device acknowledges address.
+#define IS31FL3733_SIM_NACK (0x01)
+
+/** Simulated device.
+  */
+typedef struct {
+  /// Address on I2C bus.
+  uint8_t address;
+  /// Page select register write lock.
+  uint8_t pswl;
+  /// Page select register.
+  uint8_t psr;
+  /// Interrupt mask register.
+  uint8_t imr;
+  /// Interrupt status register.
+  uint8_t isr;
+  /// Paged registers.
+  uint8_t pages[4][IS31FL3733_SIM_PAGE_SIZE];
+  /// Injected open LEDs, bitmask in LEDONOFF layout.
+  uint8_t open[IS31FL3733_SW * IS31FL3733_CS / 8];
+  /// Injected short LEDs, bitmask in LEDONOFF layout.
+  uint8_t shorted[IS31FL3733_SW * IS31FL3733_CS / 8];
+} IS31FL3733_SIM_DEVICE;
+
+/** Transaction record.
+  */
+typedef struct {
+  /// Device address on I2C bus.
+  uint8_t i2c_addr;
+  /// Non-zero for read transaction.
+  uint8_t read;
+  /// Active page of device at start of transaction.
+  uint8_t page;
+  /// First register address.
+  uint8_t reg_addr;
+  /// Number of transferred data bytes.
+  uint8_t count;
+  /// Transaction status.
+  uint8_t status;
+  /// Transaction time on bus, ns.
+  uint32_t time;
+  /// First transferred data bytes.
+  uint8_t data[IS31FL3733_SIM_LOG_DATA];
+} IS31FL3733_SIM_RECORD;
+
+/** Simulated I2C bus with devices.
+  */
+typedef struct IS31FL3733_SIM IS31FL3733_SIM;
+struct IS31FL3733_SIM {
+  /// Transport interface. Must be first member.
+  IS31FL3733_TRANSPORT transport;
+  /// Bus clock, Hz.
+  uint32_t clock;
+  /// Number of simulated devices.
+  uint8_t count;
+  /// Simulated devices.
+  IS31FL3733_SIM_DEVICE devices[IS31FL3733_SIM_DEVICES];
+  /// Number of transactions.
+  uint32_t transactions;
+  /// Number of transferred bytes including device and register addresses.
+  uint32_t bytes;
+  /// Total time on bus, ns.
+  uint64_t time;
+  /// Transaction log, last IS31FL3733_SIM_LOG_SIZE records.
+  IS31FL3733_SIM_RECORD log[IS31FL3733_SIM_LOG_SIZE];
+  /// Optional pointer to function called for each transaction with full payload.
+  void (*on_transaction) (IS31FL3733_SIM *sim, IS31FL3733_SIM_RECORD *record, uint8_t *buffer);
+};
+
+/// Initialize simulated bus with bus clock in Hz and select it for IS31FL3733_Sim_I2C* functions.
+void IS31FL3733_Sim_Init (IS31FL3733_SIM *sim, uint32_t clock);
+/// Select simulated bus for IS31FL3733_Sim_I2C* functions.
+void IS31FL3733_Sim_Select (IS31FL3733_SIM *sim);
+/// Add simulated device in power-on state.
+IS31FL3733_SIM_DEVICE *IS31FL3733_Sim_AddDevice (IS31FL3733_SIM *sim, uint8_t address);
+/// Get simulated device by address, NULL if not found.
+IS31FL3733_SIM_DEVICE *IS31FL3733_Sim_GetDevice (IS31FL3733_SIM *sim, uint8_t address);
+/// Attach simulated bus to device as transport.
+void IS31FL3733_Sim_Attach (IS31FL3733_SIM *sim, IS31FL3733 *device);
+/// Clear transaction counters and log.
+void IS31FL3733_Sim_ResetStats (IS31FL3733_SIM *sim);
+/// Get transaction record, 0 is the oldest of last IS31FL3733_SIM_LOG_SIZE records.
+IS31FL3733_SIM_RECORD *IS31FL3733_Sim_GetRecord (IS31FL3733_SIM *sim, uint32_t n);
+/// Inject LED fault detected by next open/short detection.
+void IS31FL3733_Sim_SetLEDStatus (IS31FL3733_SIM_DEVICE *device, uint8_t cs, uint8_t sw, IS31FL3733_LED_STATUS status);
+/// Simulate end of ABM operation.
+void IS31FL3733_Sim_FinishABM (IS31FL3733_SIM_DEVICE *device, uint8_t n);
+/// Get INTB pin state: 0 - interrupt asserted (pin low).
+uint8_t IS31FL3733_Sim_GetINTB (IS31FL3733_SIM_DEVICE *device);
+/// Simulated bus write function for i2c_write_reg pointer.
+uint8_t IS31FL3733_Sim_I2CWriteReg (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+/// Simulated bus read function for i2c_read_reg pointer.
+uint8_t IS31FL3733_Sim_I2CReadReg (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count);
+
+#endif /* _IS31FL3733_SIM_H_ */
@@ -0,0 +1,233 @@
+#include "is31fl3733_timeline.h"
+
+#include <string.h>
+
+/// Shortest ABM period time, ms. Other period times are doubled.
+#define IS31FL3733_ABM_TIME_BASE (210)
+
+static uint8_t
+IS31FL3733_Timeline_Quantize (uint32_t time, uint8_t steps, uint8_t *step)
+{
+  uint8_t k;
+  
+  // Find ABM period time equal to requested time.
+  for (k = 0; k < steps; k++)
+  {
+    if (time == ((uint32_t)IS31FL3733_ABM_TIME_BASE << k))
+    {
+      *step = k;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static uint8_t
+IS31FL3733_Timeline_ToABM (const IS31FL3733_EFFECT *effect, IS31FL3733_ABM *config)
+{
+  uint8_t t1;
+  uint8_t t2 = 0;
+  uint8_t t3;
+  uint8_t t4 = 0;
+  
+  // ABM breathes from 0 to LED PWM value, all LEDs start together.
+  if ((effect->type != IS31FL3733_EFFECT_BREATH) || (effect->from != 0) || (effect->start != 0) ||
+      (effect->Times > IS31FL3733_ABM_LOOP_TIMES_MAX))
+  {
+    return 0;
+  }
+  // All times must match ABM period times, hold times could be zero.
+  if (!IS31FL3733_Timeline_Quantize (effect->T1, 8, &t1) ||
+      !IS31FL3733_Timeline_Quantize (effect->T3, 8, &t3) ||
+      ((effect->T2 != 0) && !IS31FL3733_Timeline_Quantize (effect->T2, 8, &t2)) ||
+      ((effect->T4 != 0) && !IS31FL3733_Timeline_Quantize (effect->T4, 10, &t4)))
+  {
+    return 0;
+  }
+  config->T1 = (IS31FL3733_ABM_T1)(t1 << 5);
+  config->T2 = (IS31FL3733_ABM_T2)((effect->T2 != 0) ? (t2 + 1) << 1 : 0);
+  config->T3 = (IS31FL3733_ABM_T3)(t3 << 5);
+  config->T4 = (IS31FL3733_ABM_T4)((effect->T4 != 0) ? (t4 + 1) << 1 : 0);
+  config->Tbegin = IS31FL3733_ABM_LOOP_BEGIN_T1;
+  config->Tend = IS31FL3733_ABM_LOOP_END_T3;
+  config->Times = effect->Times;
+  return 1;
+}
+
+static uint8_t
+IS31FL3733_Timeline_Value (const IS31FL3733_EFFECT *effect, uint32_t time)
+{
+  uint32_t period;
+  int32_t range;
+  
+  range = (int32_t)effect->to - effect->from;
+  // Effect is not started yet.
+  if (time < effect->start)
+  {
+    return (effect->type == IS31FL3733_EFFECT_CONSTANT) ? effect->to : effect->from;
+  }
+  time -= effect->start;
+  switch (effect->type)
+  {
+    case IS31FL3733_EFFECT_FADE:
+      if (time >= effect->T1)
+      {
+        return effect->to;
+      }
+      return (uint8_t)(effect->from + range * (int32_t)time / (int32_t)effect->T1);
+    case IS31FL3733_EFFECT_BREATH:
+      period = effect->T1 + effect->T2 + effect->T3 + effect->T4;
+      // Stay at start value after last loop.
+      if ((period == 0) || ((effect->Times != IS31FL3733_ABM_LOOP_FOREVER) && (time / period >= effect->Times)))
+      {
+        return effect->from;
+      }
+      time %= period;
+      if (time < effect->T1)
+      {
+        return (uint8_t)(effect->from + range * (int32_t)time / (int32_t)effect->T1);
+      }
+      time -= effect->T1;
+      if (time < effect->T2)
+      {
+        return effect->to;
+      }
+      time -= effect->T2;
+      if (time < effect->T3)
+      {
+        return (uint8_t)(effect->to - range * (int32_t)time / (int32_t)effect->T3);
+      }
+      return effect->from;
+    default:
+      return effect->to;
+  }
+}
+
+void
+IS31FL3733_Timeline_Init (IS31FL3733_TIMELINE *timeline, IS31FL3733 *device)
+{
+  timeline->device = device;
+  timeline->count = 0;
+  timeline->start = 0;
+  memset (timeline->leds, IS31FL3733_TIMELINE_NONE, sizeof(timeline->leds));
+}
+
+uint8_t
+IS31FL3733_Timeline_AddEffect (IS31FL3733_TIMELINE *timeline, const IS31FL3733_EFFECT *effect)
+{
+  // Check free space.
+  if (timeline->count >= IS31FL3733_TIMELINE_EFFECTS)
+  {
+    return IS31FL3733_TIMELINE_NONE;
+  }
+  timeline->effects[timeline->count] = *effect;
+  timeline->modes[timeline->count] = IS31FL3733_LED_MODE_PWM;
+  return timeline->count++;
+}
+
+void
+IS31FL3733_Timeline_Assign (IS31FL3733_TIMELINE *timeline, uint8_t cs, uint8_t sw, uint8_t effect)
+{
+  uint8_t sw_first = 0;
+  uint8_t sw_last = IS31FL3733_SW - 1;
+  uint8_t cs_first = 0;
+  uint8_t cs_last = IS31FL3733_CS - 1;
+  
+  // Check effect index.
+  if ((effect >= timeline->count) && (effect != IS31FL3733_TIMELINE_NONE))
+  {
+    return;
+  }
+  // Select single row or column, if in boundaries.
+  if (sw < IS31FL3733_SW)
+  {
+    sw_first = sw_last = sw;
+  }
+  if (cs < IS31FL3733_CS)
+  {
+    cs_first = cs_last = cs;
+  }
+  for (sw = sw_first; sw <= sw_last; sw++)
+  {
+    for (cs = cs_first; cs <= cs_last; cs++)
+    {
+      timeline->leds[sw * IS31FL3733_CS + cs] = effect;
+    }
+  }
+}
+
+uint8_t
+IS31FL3733_Timeline_Start (IS31FL3733_TIMELINE *timeline, uint32_t now)
+{
+  IS31FL3733_ABM config;
+  uint8_t used[IS31FL3733_TIMELINE_EFFECTS];
+  uint8_t hardware = 0;
+  uint8_t i;
+  
+  // Find effects assigned to any LED.
+  memset (used, 0, sizeof(used));
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    if (timeline->leds[i] < timeline->count)
+    {
+      used[timeline->leds[i]] = 1;
+    }
+  }
+  // Request ABM functions for eligible effects, effects with equal timings share ABM function.
+  IS31FL3733_ABMManager_Init (&timeline->abm, timeline->device);
+  for (i = 0; i < timeline->count; i++)
+  {
+    timeline->modes[i] = IS31FL3733_LED_MODE_PWM;
+    // Unused effect doesn't take ABM function, effect stays in software, if all ABM functions are in use.
+    if (used[i] && IS31FL3733_Timeline_ToABM (&timeline->effects[i], &config))
+    {
+      timeline->modes[i] = IS31FL3733_ABMManager_Request (&timeline->abm, &config);
+    }
+    if (timeline->modes[i] != IS31FL3733_LED_MODE_PWM)
+    {
+      hardware++;
+    }
+  }
+  // Set LED modes, ABM peak value is LED PWM value.
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    if (timeline->leds[i] >= timeline->count)
+    {
+      continue;
+    }
+    IS31FL3733_UpdateLEDMode (timeline->device, i % IS31FL3733_CS, i / IS31FL3733_CS, timeline->modes[timeline->leds[i]]);
+    if (timeline->modes[timeline->leds[i]] != IS31FL3733_LED_MODE_PWM)
+    {
+      IS31FL3733_UpdateLEDPWM (timeline->device, i % IS31FL3733_CS, i / IS31FL3733_CS, timeline->effects[timeline->leds[i]].to);
+    }
+  }
+  // Write software effects initial values, LED modes and PWM values.
+  timeline->start = now;
+  IS31FL3733_Timeline_Tick (timeline, now);
+  // Write ABM configuration and start ABM operation.
+  if (hardware != 0)
+  {
+    IS31FL3733_ABMManager_Apply (&timeline->abm);
+  }
+  return hardware;
+}
+
+void
+IS31FL3733_Timeline_Tick (IS31FL3733_TIMELINE *timeline, uint32_t now)
+{
+  uint8_t effect;
+  uint8_t i;
+  
+  // Update LEDs with software effects.
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+  {
+    effect = timeline->leds[i];
+    if ((effect < timeline->count) && (timeline->modes[effect] == IS31FL3733_LED_MODE_PWM))
+    {
+      IS31FL3733_UpdateLEDPWM (timeline->device, i % IS31FL3733_CS, i / IS31FL3733_CS,
+                               IS31FL3733_Timeline_Value (&timeline->effects[effect], now - timeline->start));
+    }
+  }
+  // Write changed registers.
+  IS31FL3733_Flush (timeline->device);
+}
@@ -0,0 +1,77 @@
+/** ISSI IS31FL3733 animation timeline with Auto Breath Mode offload.
+  */
+#ifndef _IS31FL3733_TIMELINE_H_
+#define _IS31FL3733_TIMELINE_H_
+
+#include "is31fl3733_abm.h"
+
+/// Maximum number of effects in timeline.
+#ifndef IS31FL3733_TIMELINE_EFFECTS
+#define IS31FL3733_TIMELINE_EFFECTS (16)
+#endif
+
+/// No effect assigned to LED.
+#define IS31FL3733_TIMELINE_NONE (0xFF)
+
+/// Effect type.
+typedef enum {
+  IS31FL3733_EFFECT_CONSTANT = 0x00, ///< Constant value "to".
+  IS31FL3733_EFFECT_FADE     = 0x01, ///< Linear fade from "from" to "to" during T1.
+  IS31FL3733_EFFECT_BREATH   = 0x02  ///< Rise during T1, hold "to" during T2, fall during T3, hold "from" during T4.
+} IS31FL3733_EFFECT_TYPE;
+
+/** Effect description, all times are in ms.
+  */
+typedef struct {
+  /// Effect type.
+  IS31FL3733_EFFECT_TYPE type;
+  /// Start value.
+  uint8_t from;
+  /// End or peak value.
+  uint8_t to;
+  /// Effect start time relative to timeline start.
+  uint32_t start;
+  /// Rise or fade time.
+  uint32_t T1;
+  /// Hold time at peak value.
+  uint32_t T2;
+  /// Fall time.
+  uint32_t T3;
+  /// Hold time at start value.
+  uint32_t T4;
+  /// Number of breath loops, IS31FL3733_ABM_LOOP_FOREVER for endless loop.
+  uint16_t Times;
+} IS31FL3733_EFFECT;
+
+/** Timeline structure.
+  */
+typedef struct {
+  /// Device driven by timeline.
+  IS31FL3733 *device;
+  /// Number of effects.
+  uint8_t count;
+  /// Effects.
+  IS31FL3733_EFFECT effects[IS31FL3733_TIMELINE_EFFECTS];
+  /// LED mode for each effect: IS31FL3733_LED_MODE_PWM for software effects or ABM function running it.
+  IS31FL3733_LED_MODE modes[IS31FL3733_TIMELINE_EFFECTS];
+  /// Effect index for each LED, IS31FL3733_TIMELINE_NONE if LED is not animated. LEDs with index out of timeline are not animated.
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS];
+  /// ABM functions shared by hardware effects.
+  IS31FL3733_ABM_MANAGER abm;
+  /// Timeline start time.
+  uint32_t start;
+} IS31FL3733_TIMELINE;
+
+/// Initialize empty timeline for device.
+void IS31FL3733_Timeline_Init (IS31FL3733_TIMELINE *timeline, IS31FL3733 *device);
+/// Add effect to timeline. Returns effect index or IS31FL3733_TIMELINE_NONE if timeline is full.
+uint8_t IS31FL3733_Timeline_AddEffect (IS31FL3733_TIMELINE *timeline, const IS31FL3733_EFFECT *effect);
+/// Assign effect to LED. Could be set ALL / CS / SW. Effect indexes out of timeline other than IS31FL3733_TIMELINE_NONE are ignored.
+void IS31FL3733_Timeline_Assign (IS31FL3733_TIMELINE *timeline, uint8_t cs, uint8_t sw, uint8_t effect);
+/// Assign ABM functions to eligible breath effects assigned to LEDs, write LED modes, PWM and ABM configuration and start timeline.
+/// Returns number of effects running in hardware.
+uint8_t IS31FL3733_Timeline_Start (IS31FL3733_TIMELINE *timeline, uint32_t now);
+/// Update LEDs with software effects and write changed registers.
+void IS31FL3733_Timeline_Tick (IS31FL3733_TIMELINE *timeline, uint32_t now);
+
+#endif /* _IS31FL3733_TIMELINE_H_ */
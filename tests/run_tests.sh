@@ -0,0 +1,34 @@
+#!/bin/sh
+# Build and run host tests on simulated bus.
+# Usage: tests/run_tests.sh, compilers and flags are taken from CC, CFLAGS, CXX and CXXFLAGS.
+set -e
+cd "$(dirname "$0")/.."
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-std=c11 -Wall -Wextra -pedantic"}
+CXX=${CXX:-c++}
+CXXFLAGS=${CXXFLAGS:-"-std=c++17 -Wall -Wextra -pedantic"}
+OUT=${OUT:-$(mktemp -d)}
+for test in tests/test_*.c; do
+  name=$(basename "$test" .c)
+  # Statistics test needs driver built with statistics.
+  DEFINES=""
+  if [ "$name" = test_stats ]; then
+    DEFINES="-DIS31FL3733_USE_STATS"
+  fi
+  $CC $CFLAGS $DEFINES -I. -o "$OUT/$name" "$test" is31fl3733*.c -lpthread
+  "$OUT/$name"
+done
+# Scalar fallback of SSE2 paths is checked on the same host, if compiler targets SSE2.
+if $CC $CFLAGS -dM -E - < /dev/null | grep -q __SSE2__; then
+  $CC $CFLAGS -mno-sse2 -I. -o "$OUT/test_state_scalar" tests/test_state.c is31fl3733*.c -lpthread
+  "$OUT/test_state_scalar"
+fi
+# C++ tests are linked with C driver compiled by C compiler.
+for source in is31fl3733*.c; do
+  $CC $CFLAGS -I. -c -o "$OUT/$(basename "$source" .c).o" "$source"
+done
+for test in tests/test_*.cpp; do
+  name=$(basename "$test" .cpp)
+  $CXX $CXXFLAGS -I. -o "$OUT/$name" "$test" "$OUT"/is31fl3733*.o -lpthread
+  "$OUT/$name"
+done
@@ -0,0 +1,89 @@
+/** Host test helpers: checks, failure counters and I2C functions with injected errors on simulated bus.
+  */
+#ifndef _IS31FL3733_TEST_H_
+#define _IS31FL3733_TEST_H_
+
+#include <stdio.h>
+#include <string.h>
+
+#include "is31fl3733_sim.h"
+
+/// Status returned by I2C functions with injected error.
+#define TEST_ERROR (0x02)
+
+/// Number of failed checks.
+static unsigned test_failures;
+/// Number of following write transfers failed by Test_I2CWriteReg.
+static unsigned test_fail_writes;
+/// Number of following read transfers failed by Test_I2CReadReg.
+static unsigned test_fail_reads;
+
+/// Count and print failed check, test continues.
+#define CHECK(condition) do { if (!(condition)) { printf ("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); test_failures++; } } while (0)
+
+/// Run test function and print its name.
+#define TEST_RUN(test) do { printf ("%s\n", #test); test (); } while (0)
+
+/// Simulated bus write function, failing while test_fail_writes is not zero.
+static inline uint8_t
+Test_I2CWriteReg (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  if (test_fail_writes != 0)
+  {
+    test_fail_writes--;
+    return TEST_ERROR;
+  }
+  return IS31FL3733_Sim_I2CWriteReg (i2c_addr, reg_addr, buffer, count);
+}
+
+/// Simulated bus read function, failing while test_fail_reads is not zero.
+static inline uint8_t
+Test_I2CReadReg (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  if (test_fail_reads != 0)
+  {
+    test_fail_reads--;
+    return TEST_ERROR;
+  }
+  return IS31FL3733_Sim_I2CReadReg (i2c_addr, reg_addr, buffer, count);
+}
+
+/// Fill device structure with garbage and set simulated bus functions, as application declares device on stack without initialization.
+static inline void
+Test_InitDevice (IS31FL3733 *device, uint8_t address)
+{
+  memset (device, 0xA5, sizeof(IS31FL3733));
+  device->address = address;
+  device->i2c_write_reg = &Test_I2CWriteReg;
+  device->i2c_read_reg = &Test_I2CReadReg;
+#ifdef IS31FL3733_USE_STATS
+  device->clock = NULL;
+#endif
+}
+
+/// Count logged transactions writing to register of any page.
+static inline unsigned
+Test_CountWrites (IS31FL3733_SIM *sim, uint8_t reg_addr)
+{
+  unsigned count = 0;
+  uint32_t n;
+  
+  for (n = 0; (n < sim->transactions) && (n < IS31FL3733_SIM_LOG_SIZE); n++)
+  {
+    if (!IS31FL3733_Sim_GetRecord (sim, n)->read && (IS31FL3733_Sim_GetRecord (sim, n)->reg_addr == reg_addr))
+    {
+      count++;
+    }
+  }
+  return count;
+}
+
+/// Print result, returns process exit code.
+static inline int
+Test_Result (void)
+{
+  printf ("%s: %u failed checks\n", (test_failures == 0) ? "PASS" : "FAIL", test_failures);
+  return (test_failures == 0) ? 0 : 1;
+}
+
+#endif /* _IS31FL3733_TEST_H_ */
@@ -0,0 +1,128 @@
+/** Asynchronous transport tests on simulated bus: transport of uninitialized device, queued transfers, failed transfers and resync.
+  */
+#include "test.h"
+#include "is31fl3733_async.h"
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chip;
+static IS31FL3733 device;
+static IS31FL3733_QUEUE queue;
+
+static void
+Setup (void)
+{
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  // Transfers stay in flight until queue waits for them.
+  memset (&queue, 0, sizeof(queue));
+  queue.i2c_submit = &IS31FL3733_Queue_MockSubmit;
+  queue.wait = &IS31FL3733_Queue_MockComplete;
+  IS31FL3733_Queue_Init (&queue, &device);
+  IS31FL3733_Init (&device);
+  IS31FL3733_Queue_Flush (&queue);
+}
+
+static void
+TestTransport (void)
+{
+  Setup ();
+  // Queue attached before initialization transfers registers of reset.
+  CHECK ((device.transport == &queue.transport) && (queue.failed == 0));
+  CHECK ((chip->pages[3][0] == IS31FL3733_CR_SSD) && (sim.transactions != 0));
+  // Garbage in transport member of device is dropped by initialization.
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_Init (&device);
+  CHECK ((device.transport == NULL) && (IS31FL3733_GetStatus (&device) == 0));
+  CHECK (sim.transactions != 0);
+  // Transport cleared with IS31FL3733_SetTransport stays cleared.
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_SetTransport (&device, NULL);
+  IS31FL3733_Init (&device);
+  CHECK (device.transport == NULL);
+  // Transport set after initialization is used by following calls.
+  IS31FL3733_Queue_Init (&queue, &device);
+  IS31FL3733_SetLEDPWM (&device, 1, 0, 10);
+  CHECK (IS31FL3733_Queue_IsBusy (&queue));
+  IS31FL3733_Queue_Flush (&queue);
+  CHECK (chip->pages[1][1] == 10);
+}
+
+static void
+TestQueue (void)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint16_t i;
+  
+  Setup ();
+  for (i = 0; i < sizeof(pwm); i++)
+  {
+    pwm[i] = (uint8_t)(i * 7);
+  }
+  // Writes return before transfer.
+  IS31FL3733_SetPWM (&device, pwm);
+  CHECK (IS31FL3733_Queue_IsBusy (&queue));
+  CHECK (chip->pages[1][1] == 0);
+  IS31FL3733_Queue_Flush (&queue);
+  CHECK (!IS31FL3733_Queue_IsBusy (&queue));
+  CHECK (memcmp (chip->pages[1], pwm, sizeof(pwm)) == 0);
+  CHECK (IS31FL3733_Queue_GetStatus (&queue) == 0);
+}
+
+static void
+TestFailedWrite (void)
+{
+  Setup ();
+  IS31FL3733_SetLEDPWM (&device, 0, 0, 1);
+  IS31FL3733_Queue_Flush (&queue);
+  // Failed data transfer leaves registers stale and page unknown.
+  test_fail_writes = 1;
+  IS31FL3733_SetLEDPWM (&device, 4, 2, 40);
+  IS31FL3733_Queue_Flush (&queue);
+  CHECK (IS31FL3733_Queue_GetStatus (&queue) == TEST_ERROR);
+  CHECK (device.page == IS31FL3733_PAGE_UNKNOWN);
+  CHECK (device.pwm_dirty[2] == (1 << 4));
+  CHECK (chip->pages[1][2 * IS31FL3733_CS + 4] == 0);
+  // Resync writes stale registers through queue.
+  CHECK (IS31FL3733_Resync (&device) == 0);
+  IS31FL3733_Queue_Flush (&queue);
+  CHECK (chip->pages[1][2 * IS31FL3733_CS + 4] == 40);
+  CHECK (device.pwm_dirty[2] == 0);
+  CHECK (IS31FL3733_Queue_GetStatus (&queue) == 0);
+}
+
+static void
+TestFailedPageSelect (void)
+{
+  Setup ();
+  IS31FL3733_SetGCC (&device, 0x30);
+  IS31FL3733_Queue_Flush (&queue);
+  // Failed PSWL write leaves Page 3 selected, PWM value is written to CR register.
+  test_fail_writes = 1;
+  IS31FL3733_SetLEDPWM (&device, 0, 0, 0x50);
+  IS31FL3733_Queue_Flush (&queue);
+  CHECK (IS31FL3733_Queue_GetStatus (&queue) == TEST_ERROR);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_CR)] == 0x50);
+  CHECK (device.page == IS31FL3733_PAGE_UNKNOWN);
+  CHECK (device.pwm_dirty[0] == 0x0001);
+  CHECK (device.config_stale == 0x00000001);
+  // Both pages are written again.
+  IS31FL3733_Resync (&device);
+  IS31FL3733_Queue_Flush (&queue);
+  CHECK (chip->pages[1][0] == 0x50);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_CR)] == device.config[IS31FL3733_GET_ADDR(IS31FL3733_CR)]);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0x30);
+  CHECK ((device.config_stale == 0) && (device.pwm_dirty[0] == 0));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestTransport);
+  TEST_RUN (TestQueue);
+  TEST_RUN (TestFailedWrite);
+  TEST_RUN (TestFailedPageSelect);
+  return Test_Result ();
+}
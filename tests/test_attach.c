@@ -0,0 +1,116 @@
+/** Warm attach tests on simulated bus: shadow buffers are restored from snapshot and device is verified.
+  */
+#include "test.h"
+
+static IS31FL3733_SIM sim;
+
+static IS31FL3733_SIM_DEVICE *
+Setup (IS31FL3733 *device)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (device);
+  IS31FL3733_Sim_ResetStats (&sim);
+  return chip;
+}
+
+static void
+NoDelay (uint32_t ms)
+{
+  (void)ms;
+}
+
+static void
+TestAttach (void)
+{
+  IS31FL3733 device;
+  IS31FL3733 attached;
+  IS31FL3733_SNAPSHOT snapshot;
+  IS31FL3733_LED_SCAN scan;
+  IS31FL3733_SIM_DEVICE *chip = Setup (&device);
+  uint8_t i;
+  
+  // Running device with detected fault.
+  IS31FL3733_Sim_SetLEDStatus (chip, 2, 1, IS31FL3733_LED_STATUS_OPEN);
+  IS31FL3733_ScanLEDs (&device, &scan, &NoDelay);
+  IS31FL3733_SetGCC (&device, 0x60);
+  for (i = 0; i < IS31FL3733_CS; i++)
+  {
+    IS31FL3733_SetLEDPWM (&device, i, 2, i * 10);
+  }
+  IS31FL3733_SetLEDState (&device, IS31FL3733_CS, 2, IS31FL3733_LED_STATE_ON);
+  CHECK (IS31FL3733_SaveSnapshot (&device, &snapshot) == 0);
+  // Attach restores shadows and reads status registers only.
+  Test_InitDevice (&attached, device.address);
+  IS31FL3733_Sim_ResetStats (&sim);
+  CHECK (IS31FL3733_Attach (&attached, &snapshot) == IS31FL3733_ATTACH_OK);
+  CHECK (Test_CountWrites (&sim, IS31FL3733_GET_ADDR(IS31FL3733_LEDPWM)) == 0);
+  CHECK (memcmp (attached.pwm, device.pwm, sizeof(device.pwm)) == 0);
+  CHECK (memcmp (attached.leds, device.leds, sizeof(device.leds)) == 0);
+  CHECK (memcmp (attached.config, device.config, sizeof(device.config)) == 0);
+  CHECK (attached.load == device.load);
+  // Next changes are written against restored shadows.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_UpdateLEDPWM (&attached, 3, 2, 30);
+  IS31FL3733_Flush (&attached);
+  CHECK (sim.transactions == 0);
+  // Corrupted snapshot is rejected.
+  snapshot.pwm[0]++;
+  CHECK (IS31FL3733_Attach (&attached, &snapshot) == IS31FL3733_ATTACH_INVALID);
+}
+
+static void
+TestAttachReset (void)
+{
+  IS31FL3733 device;
+  IS31FL3733 attached;
+  IS31FL3733_SNAPSHOT snapshot;
+  IS31FL3733_LED_SCAN scan;
+  IS31FL3733_SIM_DEVICE *chip = Setup (&device);
+  
+  // Snapshot without detected faults can't be verified, but state is restored for caller trusting it.
+  IS31FL3733_SetGCC (&device, 0x60);
+  IS31FL3733_SetLEDPWM (&device, IS31FL3733_CS, IS31FL3733_SW, 0x20);
+  CHECK (IS31FL3733_SaveSnapshot (&device, &snapshot) == 0);
+  Test_InitDevice (&attached, device.address);
+  IS31FL3733_Sim_ResetStats (&sim);
+  CHECK (IS31FL3733_Attach (&attached, &snapshot) == IS31FL3733_ATTACH_UNVERIFIED);
+  CHECK (Test_CountWrites (&sim, IS31FL3733_GET_ADDR(IS31FL3733_LEDPWM)) == 0);
+  CHECK (memcmp (attached.pwm, device.pwm, sizeof(device.pwm)) == 0);
+  CHECK (memcmp (attached.config, device.config, sizeof(device.config)) == 0);
+  CHECK (attached.load == device.load);
+  IS31FL3733_UpdateLEDPWM (&attached, 7, 7, 0x21);
+  CHECK (IS31FL3733_Flush (&attached) == 0);
+  CHECK (chip->pages[1][7 * IS31FL3733_CS + 7] == 0x21);
+  // Reset device can't be told apart from snapshot without faults.
+  IS31FL3733_ReadPagedReg (&device, IS31FL3733_RESET);
+  CHECK (IS31FL3733_Attach (&attached, &snapshot) == IS31FL3733_ATTACH_UNVERIFIED);
+  // Device with detected faults doesn't match such snapshot.
+  IS31FL3733_Sim_SetLEDStatus (chip, 0, 0, IS31FL3733_LED_STATUS_OPEN);
+  IS31FL3733_ScanLEDs (&device, &scan, &NoDelay);
+  CHECK (IS31FL3733_Attach (&attached, &snapshot) == IS31FL3733_ATTACH_MISMATCH);
+  IS31FL3733_Sim_SetLEDStatus (chip, 0, 0, IS31FL3733_LED_STATUS_NORMAL);
+  // Device reset between snapshot and attach is detected.
+  IS31FL3733_Init (&device);
+  IS31FL3733_Sim_SetLEDStatus (chip, 15, 11, IS31FL3733_LED_STATUS_SHORT);
+  IS31FL3733_ScanLEDs (&device, &scan, &NoDelay);
+  CHECK (IS31FL3733_SaveSnapshot (&device, &snapshot) == 0);
+  IS31FL3733_ReadPagedReg (&device, IS31FL3733_RESET);
+  CHECK (IS31FL3733_Attach (&attached, &snapshot) == IS31FL3733_ATTACH_MISMATCH);
+  // Driver works again after initialization.
+  IS31FL3733_Init (&attached);
+  IS31FL3733_SetLEDPWM (&attached, 1, 1, 0x11);
+  CHECK (chip->pages[1][1 * IS31FL3733_CS + 1] == 0x11);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestAttach);
+  TEST_RUN (TestAttachReset);
+  return Test_Result ();
+}
@@ -0,0 +1,90 @@
+/** Command list tests on simulated bus: replay of recorded list is equivalent to direct driver calls.
+  */
+#include "test.h"
+#include "is31fl3733_abm.h"
+#include "is31fl3733_cmd.h"
+
+static IS31FL3733_SIM sim;
+
+static void
+Draw (IS31FL3733 *device)
+{
+  uint8_t i;
+  
+  IS31FL3733_SetGCC (device, 0x70);
+  IS31FL3733_SetSWPUR (device, IS31FL3733_RESISTOR_2K);
+  for (i = 0; i < IS31FL3733_CS; i++)
+  {
+    IS31FL3733_SetLEDPWM (device, i, i % IS31FL3733_SW, (uint8_t)(i * 16 + 1));
+  }
+  IS31FL3733_SetLEDState (device, IS31FL3733_CS, 3, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_SetLEDState (device, 5, IS31FL3733_SW, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_SetLEDMode (device, 2, 2, IS31FL3733_LED_MODE_ABM2);
+}
+
+static void
+TestReplay (void)
+{
+  static const uint8_t empty_psr[] = { IS31FL3733_PSR, 0, 0x00, 1, 0xFF };
+  static const uint8_t long_psr[] = { IS31FL3733_PSR, 2, 0x01, 0x00, 0x00, 1, 0x00 };
+  static const uint8_t empty_pswl[] = { IS31FL3733_PSWL, 0, IS31FL3733_PSR, 1, 0x01, 0x00, 1, 0x00 };
+  static uint8_t list[1024];
+  IS31FL3733 direct;
+  IS31FL3733 replayed;
+  IS31FL3733 recorded;
+  IS31FL3733_RECORDER recorder;
+  IS31FL3733_SIM_DEVICE *chips[2];
+  uint16_t length;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chips[0] = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  chips[1] = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_VCC));
+  Test_InitDevice (&direct, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&replayed, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_VCC));
+  IS31FL3733_Init (&direct);
+  IS31FL3733_Init (&replayed);
+  // Record on separate instance with the same state as replayed device.
+  recorded = replayed;
+  IS31FL3733_Cmd_StartRecord (&recorder, &recorded, list, sizeof(list));
+  Draw (&recorded);
+  length = IS31FL3733_Cmd_StopRecord (&recorder);
+  CHECK (length != 0);
+  CHECK (recorded.transport == NULL);
+  // Direct calls and replay leave the same registers and shadow buffers.
+  Draw (&direct);
+  CHECK (IS31FL3733_Cmd_Replay (&replayed, list, length) == 0);
+  CHECK (memcmp (chips[0]->pages, chips[1]->pages, sizeof(chips[0]->pages)) == 0);
+  CHECK (memcmp (direct.leds, replayed.leds, sizeof(direct.leds)) == 0);
+  CHECK (memcmp (direct.pwm, replayed.pwm, sizeof(direct.pwm)) == 0);
+  CHECK (memcmp (direct.modes, replayed.modes, sizeof(direct.modes)) == 0);
+  CHECK (memcmp (direct.config, replayed.config, sizeof(direct.config)) == 0);
+  CHECK (direct.load == replayed.load);
+  // Replay writes registers left stale by failed writes.
+  test_fail_writes = 1000;
+  IS31FL3733_SetGCC (&replayed, 0x01);
+  IS31FL3733_SetLEDState (&replayed, IS31FL3733_CS, 3, IS31FL3733_LED_STATE_OFF);
+  test_fail_writes = 0;
+  CHECK ((replayed.leds_stale != 0) && (replayed.config_stale != 0));
+  CHECK (IS31FL3733_Cmd_Replay (&replayed, list, length) == 0);
+  CHECK ((replayed.leds_stale == 0) && (replayed.config_stale == 0));
+  CHECK (memcmp (chips[0]->pages, chips[1]->pages, sizeof(chips[0]->pages)) == 0);
+  CHECK (direct.load == replayed.load);
+  // Replay of truncated list fails.
+  CHECK (IS31FL3733_Cmd_Replay (&replayed, list, length - 1) == 1);
+  // Page select records without value or with more values are malformed.
+  CHECK (IS31FL3733_Cmd_Replay (&replayed, empty_psr, sizeof(empty_psr)) == 1);
+  CHECK (IS31FL3733_Cmd_Replay (&replayed, long_psr, sizeof(long_psr)) == 1);
+  CHECK (IS31FL3733_Cmd_Replay (&replayed, empty_pswl, sizeof(empty_pswl)) == 1);
+  CHECK (memcmp (chips[0]->pages, chips[1]->pages, sizeof(chips[0]->pages)) == 0);
+  // Overflowing list is not returned.
+  IS31FL3733_Cmd_StartRecord (&recorder, &recorded, list, 8);
+  Draw (&recorded);
+  CHECK (IS31FL3733_Cmd_StopRecord (&recorder) == 0);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestReplay);
+  return Test_Result ();
+}
@@ -0,0 +1,89 @@
+/** Display tests on simulated bus: LED states are written by flush together with PWM values, flush reports errors.
+  */
+#include "test.h"
+#include "is31fl3733_display.h"
+
+/// Display of two devices side by side on shared bus.
+#define WIDTH (2 * IS31FL3733_CS)
+#define HEIGHT (IS31FL3733_SW)
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chips[2];
+static IS31FL3733 devices[2];
+static IS31FL3733_DISPLAY display;
+
+static void
+Setup (void)
+{
+  uint8_t i;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  test_fail_writes = 0;
+  memset (&display, 0, sizeof(display));
+  display.width = WIDTH;
+  display.height = HEIGHT;
+  display.count = 2;
+  for (i = 0; i < 2; i++)
+  {
+    chips[i] = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, i));
+    Test_InitDevice (&devices[i], IS31FL3733_I2C_ADDR(ADDR_GND, i));
+    display.tiles[i].device = &devices[i];
+    display.tiles[i].x = i * IS31FL3733_CS;
+  }
+  IS31FL3733_Display_Init (&display);
+  IS31FL3733_Sim_ResetStats (&sim);
+}
+
+static void
+TestDeferredState (void)
+{
+  static uint8_t states[WIDTH * HEIGHT];
+  static uint8_t pwm[WIDTH * HEIGHT];
+  
+  Setup ();
+  memset (pwm, 0x20, sizeof(pwm));
+  states[0] = 1;
+  states[3 * WIDTH + IS31FL3733_CS + 9] = 1;
+  // Shadows and load are updated without bus access.
+  IS31FL3733_Display_UpdatePWM (&display, pwm);
+  IS31FL3733_Display_SetState (&display, states);
+  CHECK (sim.transactions == 0);
+  CHECK ((devices[0].leds[0] == 0x01) && (devices[1].leds[3 * 2 + 1] == 0x02));
+  CHECK ((devices[0].load == 0x20) && (devices[1].load == 0x20));
+  // Flush writes changed LED states and PWM values.
+  CHECK (IS31FL3733_Display_Flush (&display) == 0);
+  CHECK (chips[0]->pages[0][0] == 0x01);
+  CHECK (chips[1]->pages[0][3 * 2 + 1] == 0x02);
+  CHECK (chips[1]->pages[1][3 * IS31FL3733_CS + 9] == 0x20);
+  CHECK ((devices[0].leds_stale == 0) && (devices[1].leds_stale == 0));
+  // Unchanged states are not written again.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_Display_SetState (&display, states);
+  IS31FL3733_Display_Flush (&display);
+  CHECK (sim.transactions == 0);
+}
+
+static void
+TestFlushError (void)
+{
+  static uint8_t states[WIDTH * HEIGHT];
+  
+  Setup ();
+  memset (states, 1, sizeof(states));
+  IS31FL3733_Display_SetState (&display, states);
+  // First error is returned, failed registers are written by next flush.
+  test_fail_writes = 1000;
+  CHECK (IS31FL3733_Display_Flush (&display) == TEST_ERROR);
+  test_fail_writes = 0;
+  CHECK (devices[0].leds_stale != 0);
+  CHECK (IS31FL3733_Display_Flush (&display) == 0);
+  CHECK ((chips[0]->pages[0][0] == 0xFF) && (chips[1]->pages[0][sizeof(devices[1].leds) - 1] == 0xFF));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestDeferredState);
+  TEST_RUN (TestFlushError);
+  return Test_Result ();
+}
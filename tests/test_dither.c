@@ -0,0 +1,144 @@
+/** Dithered framebuffer tests on simulated bus: average of subframes, spread of toggles and writes of toggled registers only.
+  */
+#include "test.h"
+#include "is31fl3733_dither.h"
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chip;
+static IS31FL3733 device;
+static IS31FL3733_DITHER dither;
+
+static void
+Setup (void)
+{
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (&device);
+  IS31FL3733_Dither_Init (&dither, &device);
+  IS31FL3733_Sim_ResetStats (&sim);
+}
+
+static void
+TestAverage (void)
+{
+  static const uint16_t values[] = { 0x0001, 0x0080, 0x1234, 0x7FFF, 0xFEFF };
+  uint32_t sums[sizeof(values) / sizeof(values[0])];
+  uint16_t n;
+  uint8_t i;
+  
+  Setup ();
+  for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+  {
+    IS31FL3733_Dither_SetLEDValue (&dither, i, i, values[i]);
+    sums[i] = 0;
+  }
+  // Sum of 256 subframes written to device is 8.8 value.
+  for (n = 0; n < 256; n++)
+  {
+    CHECK (IS31FL3733_Dither_Step (&dither) == 0);
+    for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+      sums[i] += chip->pages[1][i * IS31FL3733_CS + i];
+    }
+  }
+  for (i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+  {
+    CHECK (sums[i] == values[i]);
+  }
+  // Highest values saturate.
+  IS31FL3733_Dither_SetLEDValue (&dither, 0, 0, 0xFFFF);
+  for (n = 0; n < 4; n++)
+  {
+    IS31FL3733_Dither_Step (&dither);
+    CHECK (chip->pages[1][0] == 0xFF);
+  }
+}
+
+static void
+TestSpread (void)
+{
+  uint8_t toggled[4][4];
+  uint8_t count;
+  uint8_t n;
+  uint8_t sw;
+  uint8_t cs;
+  
+  Setup ();
+  memset (toggled, 0xFF, sizeof(toggled));
+  // Quarter step in all LEDs: each LED is one step higher in one of four subframes.
+  IS31FL3733_Dither_SetLEDValue (&dither, IS31FL3733_CS, IS31FL3733_SW, 0x1040);
+  for (n = 0; n < 4; n++)
+  {
+    IS31FL3733_Dither_Step (&dither);
+    for (sw = 0; sw < 4; sw++)
+    {
+      for (cs = 0; cs < 4; cs++)
+      {
+        if (chip->pages[1][sw * IS31FL3733_CS + cs] == 0x11)
+        {
+          toggled[sw][cs] = n;
+        }
+      }
+    }
+  }
+  // Horizontal and vertical neighbours toggle in different subframes.
+  for (sw = 0; sw < 4; sw++)
+  {
+    for (cs = 0; cs < 4; cs++)
+    {
+      CHECK ((cs == 3) || (toggled[sw][cs] != toggled[sw][cs + 1]));
+      CHECK ((sw == 3) || (toggled[sw][cs] != toggled[sw + 1][cs]));
+    }
+  }
+  // The same number of LEDs is one step higher in each subframe.
+  for (n = 0; n < 4; n++)
+  {
+    count = 0;
+    for (sw = 0; sw < 4; sw++)
+    {
+      for (cs = 0; cs < 4; cs++)
+      {
+        count += toggled[sw][cs] == n;
+      }
+    }
+    CHECK (count == 4);
+  }
+}
+
+static void
+TestToggledWrites (void)
+{
+  uint8_t n;
+  
+  Setup ();
+  // Half step in single LED, other LEDs have integer values.
+  IS31FL3733_Dither_SetLEDValue (&dither, IS31FL3733_CS, IS31FL3733_SW, 0x0500);
+  IS31FL3733_Dither_SetLEDValue (&dither, 6, 5, 0x0580);
+  IS31FL3733_Dither_Step (&dither);
+  CHECK ((chip->pages[1][0] == 0x05) && (chip->pages[1][sizeof(chip->pages[1]) - 1] == 0x05));
+  // Only toggled register is written in each next subframe.
+  for (n = 0; n < 8; n++)
+  {
+    IS31FL3733_Sim_ResetStats (&sim);
+    CHECK (IS31FL3733_Dither_Step (&dither) == 0);
+    CHECK (sim.transactions == 1);
+    CHECK ((IS31FL3733_Sim_GetRecord (&sim, 0)->reg_addr == 5 * IS31FL3733_CS + 6) && (IS31FL3733_Sim_GetRecord (&sim, 0)->count == 1));
+  }
+  // Integer values don't toggle.
+  IS31FL3733_Dither_SetLEDValue (&dither, 6, 5, 0x0600);
+  IS31FL3733_Dither_Step (&dither);
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_Dither_Step (&dither);
+  CHECK (sim.transactions == 0);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestAverage);
+  TEST_RUN (TestSpread);
+  TEST_RUN (TestToggledWrites);
+  return Test_Result ();
+}
@@ -0,0 +1,117 @@
+/** Interrupt event tests on simulated bus: notified status is dispatched once, failed status read keeps notification.
+  */
+#include "test.h"
+#include "is31fl3733_event.h"
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chip;
+static IS31FL3733 device;
+static IS31FL3733_EVENTS events;
+/// Bits of finished ABM functions reported by events.
+static uint8_t finished;
+/// Number of fault events.
+static uint8_t faults;
+
+static void
+OnABM (IS31FL3733_EVENTS *events, IS31FL3733_ABM_NUM n)
+{
+  (void)events;
+  switch (n)
+  {
+    case IS31FL3733_ABM_NUM_1:
+      finished |= 0x01;
+      break;
+    case IS31FL3733_ABM_NUM_2:
+      finished |= 0x02;
+      break;
+    case IS31FL3733_ABM_NUM_3:
+      finished |= 0x04;
+      break;
+  }
+}
+
+static void
+OnOpen (IS31FL3733_EVENTS *events)
+{
+  (void)events;
+  faults++;
+}
+
+static void
+NoDelay (uint32_t ms)
+{
+  (void)ms;
+}
+
+static void
+Setup (void)
+{
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  test_fail_reads = 0;
+  IS31FL3733_Init (&device);
+  memset (&events, 0, sizeof(events));
+  events.on_abm = &OnABM;
+  events.on_open = &OnOpen;
+  IS31FL3733_Events_Init (&events, &device, IS31FL3733_IMR_IAB | IS31FL3733_IMR_IO);
+  finished = 0;
+  faults = 0;
+}
+
+static void
+TestDispatch (void)
+{
+  Setup ();
+  CHECK (chip->imr == (IS31FL3733_IMR_IAB | IS31FL3733_IMR_IO));
+  // Status is not read without notification.
+  IS31FL3733_Sim_FinishABM (chip, 1);
+  IS31FL3733_Sim_FinishABM (chip, 3);
+  IS31FL3733_Sim_ResetStats (&sim);
+  CHECK (IS31FL3733_Events_Process (&events) == 0);
+  CHECK (sim.transactions == 0);
+  // Notified status is read, cleared and dispatched once.
+  IS31FL3733_Events_Notify (&events);
+  CHECK (IS31FL3733_Events_Process (&events) == (IS31FL3733_ISR_ABM1 | IS31FL3733_ISR_ABM3));
+  CHECK ((finished == 0x05) && (faults == 0));
+  CHECK (IS31FL3733_Sim_GetINTB (chip) == 1);
+  CHECK (events.pending == 0);
+  CHECK (IS31FL3733_Events_Process (&events) == 0);
+  CHECK (finished == 0x05);
+}
+
+static void
+TestReadFailure (void)
+{
+  IS31FL3733_LED_SCAN scan;
+  
+  Setup ();
+  IS31FL3733_Sim_SetLEDStatus (chip, 0, 0, IS31FL3733_LED_STATUS_OPEN);
+  IS31FL3733_Sim_FinishABM (chip, 2);
+  IS31FL3733_Events_Notify (&events);
+  // Failed status read dispatches nothing and keeps notification.
+  test_fail_reads = 1000;
+  CHECK (IS31FL3733_Events_Process (&events) == 0);
+  test_fail_reads = 0;
+  CHECK (IS31FL3733_GetStatus (&device) == TEST_ERROR);
+  CHECK ((events.pending == 1) && (finished == 0));
+  CHECK (IS31FL3733_Sim_GetINTB (chip) == 0);
+  // Events are dispatched by next call.
+  CHECK (IS31FL3733_Events_Process (&events) == IS31FL3733_ISR_ABM2);
+  CHECK ((events.pending == 0) && (finished == 0x02));
+  // Transient read error is repeated.
+  IS31FL3733_ScanLEDs (&device, &scan, &NoDelay);
+  IS31FL3733_Events_Notify (&events);
+  test_fail_reads = IS31FL3733_RETRIES;
+  CHECK (IS31FL3733_Events_Process (&events) == IS31FL3733_ISR_OB);
+  CHECK ((events.pending == 0) && (faults == 1));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestDispatch);
+  TEST_RUN (TestReadFailure);
+  return Test_Result ();
+}
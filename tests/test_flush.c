@@ -0,0 +1,64 @@
+/** Shadow buffer tests on simulated bus: updates don't access bus, flush writes only changed registers.
+  */
+#include <stdlib.h>
+
+#include "test.h"
+
+static IS31FL3733_SIM sim;
+
+static IS31FL3733_SIM_DEVICE *
+Setup (IS31FL3733 *device)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (device);
+  IS31FL3733_Sim_ResetStats (&sim);
+  return chip;
+}
+
+static void
+TestFlush (void)
+{
+  IS31FL3733 device;
+  IS31FL3733_SIM_DEVICE *chip = Setup (&device);
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint16_t i;
+  
+  // Shadow updates don't access bus.
+  for (i = 0; i < sizeof(pwm); i++)
+  {
+    pwm[i] = (uint8_t)rand ();
+  }
+  IS31FL3733_UpdatePWM (&device, pwm);
+  CHECK (sim.transactions == 0);
+  CHECK (IS31FL3733_Flush (&device) == 0);
+  CHECK (memcmp (chip->pages[1], pwm, sizeof(pwm)) == 0);
+  for (i = 0; i < IS31FL3733_SW; i++)
+  {
+    CHECK (device.pwm_dirty[i] == 0);
+  }
+  // Nothing is written again.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_UpdatePWM (&device, pwm);
+  IS31FL3733_Flush (&device);
+  CHECK (sim.transactions == 0);
+  // Only changed registers are written, short gaps are sent within one burst.
+  IS31FL3733_UpdateLEDPWM (&device, 1, 7, (uint8_t)(pwm[7 * IS31FL3733_CS + 1] + 1));
+  IS31FL3733_UpdateLEDPWM (&device, 3, 7, (uint8_t)(pwm[7 * IS31FL3733_CS + 3] + 1));
+  CHECK (device.pwm_dirty[7] == 0x000A);
+  IS31FL3733_Flush (&device);
+  CHECK (sim.transactions == 1);
+  CHECK (IS31FL3733_Sim_GetRecord (&sim, 0)->count == 3);
+  CHECK (memcmp (chip->pages[1], device.pwm, sizeof(device.pwm)) == 0);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestFlush);
+  return Test_Result ();
+}
@@ -0,0 +1,226 @@
+/** Raster operation tests on simulated bus: clipping, transparency key, scrolling and bursts written by flush.
+  */
+#include "test.h"
+#include "is31fl3733_gfx.h"
+
+/// Sprite larger than matrix.
+#define SPRITE_W (IS31FL3733_CS + 4)
+#define SPRITE_H (IS31FL3733_SW + 2)
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chip;
+static IS31FL3733 device;
+
+static void
+Setup (void)
+{
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (&device);
+  IS31FL3733_Sim_ResetStats (&sim);
+}
+
+/// Fill matrix with PWM value unique for each LED.
+static void
+DrawPattern (void)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t i;
+  
+  for (i = 0; i < sizeof(pwm); i++)
+  {
+    pwm[i] = i + 1;
+  }
+  IS31FL3733_UpdateRawPWM (&device, pwm);
+}
+
+static void
+TestClip (void)
+{
+  static uint8_t sprite[SPRITE_H][SPRITE_W];
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t sw;
+  uint8_t cs;
+  
+  Setup ();
+  for (sw = 0; sw < SPRITE_H; sw++)
+  {
+    for (cs = 0; cs < SPRITE_W; cs++)
+    {
+      sprite[sw][cs] = (uint8_t)(sw * SPRITE_W + cs);
+    }
+  }
+  // Sprite larger than matrix at negative position: clipped pixels on the left and top are skipped in source.
+  IS31FL3733_Gfx_BlitPWM (&device, -3, -1, SPRITE_W, SPRITE_H, &sprite[0][0], SPRITE_W, IS31FL3733_GFX_NO_KEY);
+  for (sw = 0; sw < IS31FL3733_SW; sw++)
+  {
+    for (cs = 0; cs < IS31FL3733_CS; cs++)
+    {
+      CHECK (device.pwm[sw * IS31FL3733_CS + cs] == sprite[sw + 1][cs + 3]);
+    }
+  }
+  // Rectangle partially outside is filled inside matrix only.
+  DrawPattern ();
+  memcpy (pwm, device.pwm, sizeof(pwm));
+  IS31FL3733_Gfx_FillPWM (&device, -3, IS31FL3733_SW - 2, 5, 10, 0xEE);
+  for (sw = 0; sw < IS31FL3733_SW; sw++)
+  {
+    for (cs = 0; cs < IS31FL3733_CS; cs++)
+    {
+      CHECK (device.pwm[sw * IS31FL3733_CS + cs] == (((cs < 2) && (sw >= IS31FL3733_SW - 2)) ? 0xEE : pwm[sw * IS31FL3733_CS + cs]));
+    }
+  }
+  // Rectangles outside of matrix don't change anything.
+  memcpy (pwm, device.pwm, sizeof(pwm));
+  IS31FL3733_Gfx_FillPWM (&device, -5, 0, 5, IS31FL3733_SW, 0x11);
+  IS31FL3733_Gfx_FillPWM (&device, 0, IS31FL3733_SW, IS31FL3733_CS, 1, 0x11);
+  IS31FL3733_Gfx_FillPWM (&device, -128, -128, 255, 100, 0x11);
+  IS31FL3733_Gfx_BlitPWM (&device, IS31FL3733_CS, 0, SPRITE_W, SPRITE_H, &sprite[0][0], SPRITE_W, IS31FL3733_GFX_NO_KEY);
+  CHECK (memcmp (device.pwm, pwm, sizeof(pwm)) == 0);
+  // LED states are clipped the same way.
+  IS31FL3733_Gfx_FillState (&device, IS31FL3733_CS - 1, -2, 4, 3, IS31FL3733_LED_STATE_ON);
+  CHECK ((device.leds[0] == 0x00) && (device.leds[1] == 0x80) && (device.leds[2] == 0x00) && (device.leds[3] == 0x00));
+  CHECK ((chip->pages[0][0] == 0x00) && (chip->pages[0][1] == 0x80));
+}
+
+static void
+TestKey (void)
+{
+  static const uint8_t sprite[3][4] = {
+    { 0x10, 0x00, 0x30, 0x99 },
+    { 0x00, 0x00, 0x40, 0x99 },
+    { 0x50, 0x60, 0x00, 0x99 }
+  };
+  static const uint8_t states[2][3] = {
+    { 1, 2, 0 },
+    { 2, 1, 2 }
+  };
+  
+  Setup ();
+  IS31FL3733_Gfx_FillPWM (&device, 0, 0, IS31FL3733_CS, IS31FL3733_SW, 0x20);
+  // Pixels equal to key are transparent, source stride skips last column.
+  IS31FL3733_Gfx_BlitPWM (&device, 5, 2, 3, 3, &sprite[0][0], 4, 0x00);
+  CHECK ((device.pwm[2 * IS31FL3733_CS + 5] == 0x10) && (device.pwm[2 * IS31FL3733_CS + 6] == 0x20) && (device.pwm[2 * IS31FL3733_CS + 7] == 0x30));
+  CHECK ((device.pwm[3 * IS31FL3733_CS + 5] == 0x20) && (device.pwm[3 * IS31FL3733_CS + 6] == 0x20) && (device.pwm[3 * IS31FL3733_CS + 7] == 0x40));
+  CHECK ((device.pwm[4 * IS31FL3733_CS + 5] == 0x50) && (device.pwm[4 * IS31FL3733_CS + 6] == 0x60) && (device.pwm[4 * IS31FL3733_CS + 7] == 0x20));
+  CHECK (device.pwm[2 * IS31FL3733_CS + 8] == 0x20);
+  // Without key all pixels are copied.
+  IS31FL3733_Gfx_BlitPWM (&device, 5, 2, 3, 1, &sprite[1][0], 4, IS31FL3733_GFX_NO_KEY);
+  CHECK ((device.pwm[2 * IS31FL3733_CS + 5] == 0x00) && (device.pwm[2 * IS31FL3733_CS + 7] == 0x40));
+  // LED states: key keeps current state, other non-zero values turn LEDs on.
+  IS31FL3733_Gfx_FillState (&device, 0, 0, 3, 2, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_Gfx_BlitState (&device, 0, 0, 3, 2, &states[0][0], 3, 2);
+  CHECK ((device.leds[0] == 0x03) && (device.leds[2] == 0x07));
+  IS31FL3733_Gfx_FillState (&device, 0, 0, 3, 2, IS31FL3733_LED_STATE_OFF);
+  IS31FL3733_Gfx_BlitState (&device, 0, 0, 3, 2, &states[0][0], 3, 2);
+  CHECK ((device.leds[0] == 0x01) && (device.leds[2] == 0x02));
+  CHECK ((chip->pages[0][0] == 0x01) && (chip->pages[0][2] == 0x02));
+}
+
+static void
+TestScroll (void)
+{
+  static const int8_t moves[4][2] = { { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -2 } };
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t expected;
+  uint8_t m;
+  int8_t sw;
+  int8_t cs;
+  
+  Setup ();
+  // Rectangle at x 2..5, y 3..7, LEDs outside it are not moved.
+  for (m = 0; m < 4; m++)
+  {
+    DrawPattern ();
+    memcpy (pwm, device.pwm, sizeof(pwm));
+    IS31FL3733_Gfx_ScrollPWM (&device, 2, 3, 4, 5, moves[m][0], moves[m][1], 0xFF);
+    for (sw = 0; sw < IS31FL3733_SW; sw++)
+    {
+      for (cs = 0; cs < IS31FL3733_CS; cs++)
+      {
+        expected = pwm[sw * IS31FL3733_CS + cs];
+        if ((cs >= 2) && (cs < 6) && (sw >= 3) && (sw < 8))
+        {
+          // LEDs moved from outside of rectangle are filled.
+          if ((cs - moves[m][0] < 2) || (cs - moves[m][0] >= 6) || (sw - moves[m][1] < 3) || (sw - moves[m][1] >= 8))
+          {
+            expected = 0xFF;
+          }
+          else
+          {
+            expected = pwm[(sw - moves[m][1]) * IS31FL3733_CS + cs - moves[m][0]];
+          }
+        }
+        CHECK (device.pwm[sw * IS31FL3733_CS + cs] == expected);
+      }
+    }
+  }
+  // Spot checks of the last move up by two rows.
+  CHECK (device.pwm[3 * IS31FL3733_CS + 2] == pwm[5 * IS31FL3733_CS + 2]);
+  CHECK ((device.pwm[6 * IS31FL3733_CS + 2] == 0xFF) && (device.pwm[7 * IS31FL3733_CS + 5] == 0xFF));
+  CHECK (device.pwm[8 * IS31FL3733_CS + 2] == pwm[8 * IS31FL3733_CS + 2]);
+  // Fill value is corrected like other PWM values.
+  IS31FL3733_SetBrightness (&device, 128);
+  IS31FL3733_Gfx_ScrollPWM (&device, 0, 0, IS31FL3733_CS, 1, 1, 0, 0xFF);
+  CHECK (device.pwm[0] == IS31FL3733_CorrectPWM (&device, 0xFF));
+  // LED states scroll left with fill.
+  IS31FL3733_Gfx_FillState (&device, 0, 0, 2, 1, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_Gfx_ScrollState (&device, 0, 0, IS31FL3733_CS, 1, -1, 0, IS31FL3733_LED_STATE_ON);
+  CHECK ((device.leds[0] == 0x01) && (device.leds[1] == 0x80));
+  CHECK ((chip->pages[0][0] == 0x01) && (chip->pages[0][1] == 0x80));
+}
+
+static void
+TestTickerFlush (void)
+{
+  static uint8_t column[7];
+  IS31FL3733_SIM_RECORD *record;
+  uint8_t sw;
+  uint8_t cs;
+  
+  Setup ();
+  // Text line of 7 rows with different neighbour values.
+  for (sw = 4; sw < 11; sw++)
+  {
+    for (cs = 0; cs < IS31FL3733_CS; cs++)
+    {
+      IS31FL3733_UpdateLEDPWM (&device, cs, sw, (uint8_t)((cs * 37 + sw * 11) | 1));
+    }
+  }
+  CHECK (IS31FL3733_Flush (&device) == 0);
+  // Ticker step: scroll left and draw new column on the right.
+  for (sw = 0; sw < sizeof(column); sw++)
+  {
+    column[sw] = sw * 2;
+  }
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_Gfx_ScrollPWM (&device, 0, 4, IS31FL3733_CS, 7, -1, 0, 0);
+  IS31FL3733_Gfx_BlitPWM (&device, IS31FL3733_CS - 1, 4, 1, 7, column, 1, IS31FL3733_GFX_NO_KEY);
+  CHECK (sim.transactions == 0);
+  // Changed rows are contiguous registers, they are written in one burst, page is already selected.
+  CHECK (IS31FL3733_Flush (&device) == 0);
+  CHECK (sim.transactions == 1);
+  record = IS31FL3733_Sim_GetRecord (&sim, 0);
+  CHECK ((record->reg_addr == 4 * IS31FL3733_CS) && (record->count == 7 * IS31FL3733_CS));
+  CHECK (memcmp (chip->pages[1], device.pwm, sizeof(device.pwm)) == 0);
+  // Rows far apart are written in separate bursts.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_Gfx_ScrollPWM (&device, 0, 4, IS31FL3733_CS, 2, -1, 0, 0);
+  IS31FL3733_Gfx_ScrollPWM (&device, 0, 9, IS31FL3733_CS, 2, -1, 0, 0);
+  CHECK (IS31FL3733_Flush (&device) == 0);
+  CHECK (sim.transactions == 2);
+  CHECK ((IS31FL3733_Sim_GetRecord (&sim, 0)->reg_addr == 4 * IS31FL3733_CS) && (IS31FL3733_Sim_GetRecord (&sim, 1)->reg_addr == 9 * IS31FL3733_CS));
+  CHECK (memcmp (chip->pages[1], device.pwm, sizeof(device.pwm)) == 0);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestClip);
+  TEST_RUN (TestKey);
+  TEST_RUN (TestScroll);
+  TEST_RUN (TestTickerFlush);
+  return Test_Result ();
+}
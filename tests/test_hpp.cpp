@@ -0,0 +1,171 @@
+/** C++ front end tests on simulated bus: wire traffic and driver state are the same as of C functions.
+  */
+#include <stdio.h>
+#include <string.h>
+
+#include "is31fl3733.hpp"
+extern "C" {
+#include "test.h"
+#include "is31fl3733_gamma.h"
+}
+
+typedef IS31FL3733_I2C<Test_I2CWriteReg, IS31FL3733_Sim_I2CReadReg> Bus;
+typedef IS31FL3733_Device<IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND), Bus> Device;
+
+static IS31FL3733_SIM sim;
+/// Hash of all transactions with full data.
+static uint32_t hash;
+static uint8_t frames[4][IS31FL3733_SW * IS31FL3733_CS];
+
+static void
+HashTransaction (IS31FL3733_SIM *sim, IS31FL3733_SIM_RECORD *record, uint8_t *buffer)
+{
+  (void)sim;
+  hash = hash * 31 + record->read;
+  hash = hash * 31 + record->page;
+  hash = hash * 31 + record->reg_addr;
+  hash = hash * 31 + record->count;
+  for (uint8_t i = 0; i < record->count; i++)
+  {
+    hash = hash * 31 + buffer[i];
+  }
+}
+
+static IS31FL3733_SIM_DEVICE *
+Setup (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  sim.on_transaction = &HashTransaction;
+  hash = 0;
+  test_fail_writes = 0;
+  return chip;
+}
+
+static void
+DrawC (IS31FL3733 *device)
+{
+  IS31FL3733_Init (device);
+  IS31FL3733_SetGCC (device, 0x80);
+  IS31FL3733_SetLEDState (device, 3, 4, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_SetLEDState (device, IS31FL3733_CS, 5, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_SetLEDState (device, 9, IS31FL3733_SW, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_SetLEDPWM (device, 3, 4, 7);
+  IS31FL3733_SetLEDPWM (device, IS31FL3733_CS, 5, 8);
+  IS31FL3733_SetLEDPWM (device, 9, IS31FL3733_SW, 9);
+  IS31FL3733_SetGamma (device, IS31FL3733_GAMMA_2_2);
+  IS31FL3733_SetBrightness (device, 200);
+  IS31FL3733_SetLEDPWM (device, IS31FL3733_CS, IS31FL3733_SW, 100);
+  IS31FL3733_SetLEDMode (device, 1, 1, IS31FL3733_LED_MODE_ABM1);
+  for (uint8_t f = 0; f < 4; f++)
+  {
+    IS31FL3733_UpdatePWM (device, frames[f]);
+    IS31FL3733_UpdateLEDPWM (device, 2, IS31FL3733_SW, f);
+    IS31FL3733_Flush (device);
+  }
+  IS31FL3733_BeginBatch (device);
+  IS31FL3733_SetLEDPWM (device, 0, 0, 1);
+  IS31FL3733_SetLEDPWM (device, 1, 0, 2);
+  IS31FL3733_EndBatch (device);
+  IS31FL3733_SetPWM (device, frames[0]);
+  IS31FL3733_SetStatePacked (device, frames[3]);
+}
+
+static void
+DrawCpp (Device &device)
+{
+  device.Init ();
+  device.SetGCC (0x80);
+  device.SetLEDState<3, 4> (IS31FL3733_LED_STATE_ON);
+  device.SetLEDState<IS31FL3733_CS, 5> (IS31FL3733_LED_STATE_ON);
+  device.SetLEDState<9, IS31FL3733_SW> (IS31FL3733_LED_STATE_ON);
+  device.SetLEDPWM<3, 4> (7);
+  device.SetLEDPWM<IS31FL3733_CS, 5> (8);
+  device.SetLEDPWM<9, IS31FL3733_SW> (9);
+  device.SetGamma (IS31FL3733_GAMMA_2_2);
+  device.SetBrightness (200);
+  device.SetLEDPWM<IS31FL3733_CS, IS31FL3733_SW> (100);
+  device.SetLEDMode<1, 1> (IS31FL3733_LED_MODE_ABM1);
+  for (uint8_t f = 0; f < 4; f++)
+  {
+    device.UpdatePWM (frames[f]);
+    device.UpdateLEDPWM<2, IS31FL3733_SW> (f);
+    device.Flush ();
+  }
+  device.BeginBatch ();
+  device.SetLEDPWM<0, 0> (1);
+  device.SetLEDPWM<1, 0> (2);
+  device.EndBatch ();
+  device.SetPWM (frames[0]);
+  device.SetStatePacked (frames[3]);
+}
+
+static void
+TestWireTraffic (void)
+{
+  static IS31FL3733 c_device;
+  Bus bus;
+  Device cpp_device (bus);
+  IS31FL3733 *device = cpp_device.Device ();
+  uint32_t c_hash;
+  uint32_t c_transactions;
+  
+  for (uint8_t f = 0; f < 4; f++)
+  {
+    for (uint16_t i = 0; i < sizeof(frames[f]); i++)
+    {
+      frames[f][i] = (uint8_t)(i * (f + 3) + (i >> f));
+    }
+  }
+  Setup ();
+  Test_InitDevice (&c_device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  DrawC (&c_device);
+  c_hash = hash;
+  c_transactions = sim.transactions;
+  // The same calls of C++ front end send the same transactions and leave the same driver state.
+  Setup ();
+  DrawCpp (cpp_device);
+  CHECK (hash == c_hash);
+  CHECK (sim.transactions == c_transactions);
+  CHECK (memcmp (device->leds, c_device.leds, sizeof(c_device.leds)) == 0);
+  CHECK (memcmp (device->pwm, c_device.pwm, sizeof(c_device.pwm)) == 0);
+  CHECK (memcmp (device->modes, c_device.modes, sizeof(c_device.modes)) == 0);
+  CHECK (memcmp (device->config, c_device.config, sizeof(c_device.config)) == 0);
+  CHECK (device->load == c_device.load);
+}
+
+static void
+TestFailedWrite (void)
+{
+  Bus bus;
+  Device device (bus);
+  IS31FL3733_SIM_DEVICE *chip = Setup ();
+  uint8_t status;
+  
+  device.Init ();
+  // Failed writes are reported and written again by resync.
+  test_fail_writes = 1000;
+  device.SetLEDState<2, 3> (IS31FL3733_LED_STATE_ON);
+  status = device.SetLEDPWM<2, 3> (50);
+  CHECK (status == TEST_ERROR);
+  test_fail_writes = 0;
+  CHECK (device.GetStatus () == TEST_ERROR);
+  CHECK (device.Device ()->leds_stale != 0);
+  CHECK (device.Device ()->load == 50);
+  CHECK (device.Resync () == 0);
+  CHECK (chip->pages[0][3 << 1] == 0x04);
+  CHECK (chip->pages[1][3 * IS31FL3733_CS + 2] == 50);
+  // C driver functions write through the same bus.
+  IS31FL3733_SetGCC (device.Device (), 0x33);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0x33);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestWireTraffic);
+  TEST_RUN (TestFailedWrite);
+  return Test_Result ();
+}
@@ -0,0 +1,44 @@
+/** Power budget limiter tests on simulated bus: GCC is kept under budget, also after GCC written by application.
+  */
+#include "test.h"
+#include "is31fl3733_limit.h"
+
+static IS31FL3733_SIM sim;
+static IS31FL3733 device;
+static IS31FL3733_LIMITER limiter;
+
+static void
+TestBudget (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  uint8_t *gcc;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  gcc = &chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)];
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  IS31FL3733_SetLEDState (&device, IS31FL3733_CS, IS31FL3733_SW, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_Limiter_Init (&limiter, &device, 40, 1000, 255, 8);
+  // Dark device is shut down.
+  CHECK (IS31FL3733_Limiter_Apply (&limiter) == 0);
+  CHECK (!(chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_CR)] & IS31FL3733_CR_SSD));
+  // Full frame is limited by GCC and device is woken up.
+  IS31FL3733_UpdateLEDPWM (&device, IS31FL3733_CS, IS31FL3733_SW, 255);
+  CHECK (IS31FL3733_Limiter_Apply (&limiter) == 0);
+  CHECK ((*gcc != 0) && (*gcc < 255));
+  CHECK (IS31FL3733_Limiter_GetCurrent (&limiter) <= 1000);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_CR)] & IS31FL3733_CR_SSD);
+  // GCC written by application is lowered by next apply.
+  IS31FL3733_SetGCC (&device, 255);
+  CHECK (IS31FL3733_Limiter_Apply (&limiter) == 0);
+  CHECK (*gcc < 255);
+  CHECK (IS31FL3733_Limiter_GetCurrent (&limiter) <= 1000);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestBudget);
+  return Test_Result ();
+}
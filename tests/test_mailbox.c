@@ -0,0 +1,140 @@
+/** Frame mailbox tests on simulated bus: newest frame wins, producer thread against bus thread.
+  */
+#include <pthread.h>
+#include <stdlib.h>
+
+#include "test.h"
+#include "is31fl3733_mailbox.h"
+
+/// Number of frames published by producer thread.
+#define THREAD_FRAMES (2000)
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chip;
+static IS31FL3733 device;
+static IS31FL3733_MAILBOX mailbox;
+static atomic_int done;
+
+static void
+Setup (void)
+{
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  IS31FL3733_Mailbox_Init (&mailbox, &device);
+}
+
+static void
+TestNewestFrame (void)
+{
+  uint8_t pwm[2][IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  uint16_t i;
+  
+  Setup ();
+  for (i = 0; i < sizeof(states); i++)
+  {
+    pwm[0][i] = (uint8_t)i;
+    pwm[1][i] = (uint8_t)(255 - i);
+    states[i] = (uint8_t)(i & 1);
+  }
+  IS31FL3733_PackState (leds, states, 0);
+  CHECK (IS31FL3733_Mailbox_Process (&mailbox) == 0);
+  // Older unwritten frame is dropped.
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, pwm[0], states) == 0);
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, pwm[1], states) == 0);
+  CHECK (atomic_load (&mailbox.dropped) == 1);
+  CHECK (IS31FL3733_Mailbox_Process (&mailbox) == 1);
+  CHECK (memcmp (chip->pages[1], pwm[1], sizeof(pwm[1])) == 0);
+  CHECK (memcmp (chip->pages[0], leds, sizeof(leds)) == 0);
+  CHECK (IS31FL3733_Mailbox_Process (&mailbox) == 0);
+  // All frame buffers are free again.
+  CHECK (IS31FL3733_Mailbox_Acquire (&mailbox) != NULL);
+}
+
+static void
+TestMergeSections (void)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  
+  Setup ();
+  memset (pwm, 0x40, sizeof(pwm));
+  memset (states, 1, sizeof(states));
+  IS31FL3733_PackState (leds, states, 0);
+  // LED states of older frame are not lost with newer PWM frame.
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, NULL, states) == 0);
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, pwm, NULL) == 0);
+  CHECK (IS31FL3733_Mailbox_Process (&mailbox) == 1);
+  CHECK (memcmp (chip->pages[1], pwm, sizeof(pwm)) == 0);
+  CHECK (memcmp (chip->pages[0], leds, sizeof(leds)) == 0);
+  // Section of newer frame wins.
+  memset (states, 0, sizeof(states));
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, NULL, states) == 0);
+  memset (states, 1, sizeof(states));
+  states[5] = 0;
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, NULL, states) == 0);
+  memset (pwm, 0x41, sizeof(pwm));
+  CHECK (IS31FL3733_Mailbox_Submit (&mailbox, pwm, NULL) == 0);
+  CHECK (atomic_load (&mailbox.dropped) == 3);
+  CHECK (IS31FL3733_Mailbox_Process (&mailbox) == 1);
+  CHECK (chip->pages[0][0] == 0xDF);
+  CHECK (chip->pages[0][1] == 0xFF);
+  CHECK (chip->pages[1][0] == 0x41);
+}
+
+static void *
+Producer (void *arg)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  int n;
+  
+  (void)arg;
+  for (n = 1; n <= THREAD_FRAMES; n++)
+  {
+    // Every frame has all registers set to frame number.
+    memset (pwm, n & 0xFF, sizeof(pwm));
+    while (IS31FL3733_Mailbox_Submit (&mailbox, pwm, NULL) != 0);
+  }
+  atomic_store (&done, 1);
+  return NULL;
+}
+
+static void
+TestThreads (void)
+{
+  pthread_t thread;
+  uint8_t last = 0;
+  uint16_t i;
+  uint8_t torn = 0;
+  
+  Setup ();
+  atomic_init (&done, 0);
+  pthread_create (&thread, NULL, &Producer, NULL);
+  // Bus thread writes frames until producer is done and last frame is written.
+  while (!atomic_load (&done) || IS31FL3733_Mailbox_Process (&mailbox))
+  {
+    IS31FL3733_Mailbox_Process (&mailbox);
+    // Written frame is never mixed from different frames.
+    for (i = 1; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+    {
+      torn |= (chip->pages[1][i] != chip->pages[1][0]);
+    }
+    last = chip->pages[1][0];
+  }
+  pthread_join (thread, NULL);
+  CHECK (!torn);
+  CHECK (last == (THREAD_FRAMES & 0xFF));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestNewestFrame);
+  TEST_RUN (TestMergeSections);
+  TEST_RUN (TestThreads);
+  return Test_Result ();
+}
@@ -0,0 +1,198 @@
+/** LED mapping tests on simulated bus: layout validation, rotation, mirroring, channel order, clipping and unpopulated LEDs.
+  */
+#include "test.h"
+#include "is31fl3733_map.h"
+
+/// Logical frame of 4x3 pixels.
+#define WIDTH (4)
+#define HEIGHT (3)
+
+static IS31FL3733_MAP map;
+static uint8_t frame[IS31FL3733_SW * IS31FL3733_CS];
+static uint8_t values[IS31FL3733_SW * IS31FL3733_CS];
+
+/// Single color layout of logical frame at CS 2, SW 1.
+static void
+InitLayout (IS31FL3733_MAP_LAYOUT *layout)
+{
+  memset (layout, 0, sizeof(IS31FL3733_MAP_LAYOUT));
+  layout->width = WIDTH;
+  layout->height = HEIGHT;
+  layout->channels = 1;
+  layout->cs = 2;
+  layout->sw = 1;
+}
+
+/// Logical frame value of pixel is its index + 1, mapped value of register is looked up by physical LED.
+static uint8_t
+Value (uint8_t cs, uint8_t sw)
+{
+  return values[sw * IS31FL3733_CS + cs];
+}
+
+static void
+Gather (const IS31FL3733_MAP_LAYOUT *layout)
+{
+  uint8_t i;
+  
+  for (i = 0; i < sizeof(frame); i++)
+  {
+    frame[i] = i + 1;
+  }
+  CHECK (IS31FL3733_Map_Init (&map, layout) == 0);
+  IS31FL3733_Map_Gather (&map, values, frame);
+}
+
+static void
+TestValidation (void)
+{
+  IS31FL3733_MAP_LAYOUT layout;
+  
+  InitLayout (&layout);
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 0);
+  // Empty frame.
+  layout.width = 0;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  layout.width = WIDTH;
+  layout.height = 0;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  // Frame larger than matrix.
+  layout.width = IS31FL3733_CS;
+  layout.height = IS31FL3733_SW + 1;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  layout.height = IS31FL3733_SW;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 0);
+  // Number of channels.
+  layout.width = WIDTH;
+  layout.height = HEIGHT;
+  layout.channels = 0;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  layout.channels = 4;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  // Channel order must be permutation of 0 to channels - 1.
+  layout.channels = 3;
+  layout.order[0] = 0;
+  layout.order[1] = 0;
+  layout.order[2] = 2;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  layout.order[1] = 3;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  layout.order[1] = 1;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 0);
+  layout.channels = 2;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 0);
+  layout.order[1] = 2;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+  layout.order[0] = 1;
+  layout.order[1] = 0;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 0);
+  layout.channels = 1;
+  CHECK (IS31FL3733_Map_Init (&map, &layout) == 1);
+}
+
+static void
+TestRotation (void)
+{
+  IS31FL3733_MAP_LAYOUT layout;
+  
+  InitLayout (&layout);
+  // Pixel (x, y) has value y * WIDTH + x + 1.
+  Gather (&layout);
+  CHECK ((Value (2, 1) == 1) && (Value (5, 1) == 4) && (Value (2, 3) == 9) && (Value (5, 3) == 12));
+  CHECK ((Value (1, 1) == 0) && (Value (6, 1) == 0) && (Value (2, 0) == 0) && (Value (2, 4) == 0));
+  // Clockwise rotations: top left pixel moves to top right, bottom right and bottom left corner of physical grid.
+  layout.rotation = IS31FL3733_MAP_ROTATE_90;
+  Gather (&layout);
+  CHECK ((Value (4, 1) == 1) && (Value (4, 4) == 4) && (Value (2, 1) == 9) && (Value (2, 4) == 12));
+  CHECK ((Value (5, 1) == 0) && (Value (2, 5) == 0));
+  layout.rotation = IS31FL3733_MAP_ROTATE_180;
+  Gather (&layout);
+  CHECK ((Value (5, 3) == 1) && (Value (2, 3) == 4) && (Value (5, 1) == 9) && (Value (2, 1) == 12));
+  layout.rotation = IS31FL3733_MAP_ROTATE_270;
+  Gather (&layout);
+  CHECK ((Value (2, 4) == 1) && (Value (2, 1) == 4) && (Value (4, 4) == 9) && (Value (4, 1) == 12));
+}
+
+static void
+TestMirror (void)
+{
+  IS31FL3733_MAP_LAYOUT layout;
+  
+  InitLayout (&layout);
+  layout.mirror = IS31FL3733_MAP_MIRROR_X;
+  Gather (&layout);
+  CHECK ((Value (5, 1) == 1) && (Value (2, 1) == 4) && (Value (5, 3) == 9));
+  layout.mirror = IS31FL3733_MAP_MIRROR_Y;
+  Gather (&layout);
+  CHECK ((Value (2, 3) == 1) && (Value (5, 3) == 4) && (Value (2, 1) == 9));
+  layout.mirror = IS31FL3733_MAP_MIRROR_X | IS31FL3733_MAP_MIRROR_Y;
+  Gather (&layout);
+  CHECK ((Value (5, 3) == 1) && (Value (2, 1) == 12));
+  // Mirroring is applied before rotation.
+  layout.mirror = IS31FL3733_MAP_MIRROR_X;
+  layout.rotation = IS31FL3733_MAP_ROTATE_90;
+  Gather (&layout);
+  CHECK ((Value (4, 4) == 1) && (Value (4, 1) == 4) && (Value (2, 4) == 9));
+}
+
+static void
+TestOrder (void)
+{
+  IS31FL3733_MAP_LAYOUT layout;
+  
+  InitLayout (&layout);
+  // RGB pixels with channels wired as B, R, G on consecutive CS lines.
+  layout.width = 2;
+  layout.height = 1;
+  layout.channels = 3;
+  layout.order[0] = 1;
+  layout.order[1] = 2;
+  layout.order[2] = 0;
+  layout.cs = 0;
+  layout.sw = 0;
+  Gather (&layout);
+  CHECK ((Value (0, 0) == 3) && (Value (1, 0) == 1) && (Value (2, 0) == 2));
+  CHECK ((Value (3, 0) == 6) && (Value (4, 0) == 4) && (Value (5, 0) == 5));
+  CHECK (Value (6, 0) == 0);
+}
+
+static void
+TestUnpopulated (void)
+{
+  static uint8_t unpopulated[IS31FL3733_SW * IS31FL3733_CS / 8];
+  static IS31FL3733_SIM sim;
+  static IS31FL3733 device;
+  IS31FL3733_SIM_DEVICE *chip;
+  IS31FL3733_MAP_LAYOUT layout;
+  
+  InitLayout (&layout);
+  // LED at CS 3, SW 1 is not populated, frame is clipped on the right side of matrix.
+  unpopulated[(1 << 1) + 0] = 0x08;
+  layout.unpopulated = unpopulated;
+  layout.cs = IS31FL3733_CS - 2;
+  Gather (&layout);
+  CHECK ((Value (IS31FL3733_CS - 2, 1) == 1) && (Value (IS31FL3733_CS - 1, 1) == 2) && (Value (IS31FL3733_CS - 1, 3) == 10));
+  layout.cs = 2;
+  Gather (&layout);
+  CHECK ((Value (2, 1) == 1) && (Value (3, 1) == 0) && (Value (4, 1) == 3) && (Value (3, 2) == 6));
+  // Unmapped LEDs are written dark and turned off.
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  IS31FL3733_Map_SetPWM (&device, &map, frame);
+  IS31FL3733_Map_SetState (&device, &map, frame);
+  CHECK ((chip->pages[1][1 * IS31FL3733_CS + 2] == 1) && (chip->pages[1][1 * IS31FL3733_CS + 3] == 0));
+  CHECK ((chip->pages[0][1 << 1] == 0x34) && (chip->pages[0][0] == 0x00));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestValidation);
+  TEST_RUN (TestRotation);
+  TEST_RUN (TestMirror);
+  TEST_RUN (TestOrder);
+  TEST_RUN (TestUnpopulated);
+  return Test_Result ();
+}
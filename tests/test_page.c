@@ -0,0 +1,80 @@
+/** Page cache tests on simulated bus: page is selected only when it changes, adjacent writes of batch are coalesced.
+  */
+#include "test.h"
+
+static IS31FL3733_SIM sim;
+
+static IS31FL3733_SIM_DEVICE *
+Setup (IS31FL3733 *device)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (device);
+  IS31FL3733_Sim_ResetStats (&sim);
+  return chip;
+}
+
+static void
+TestPageCache (void)
+{
+  IS31FL3733 device;
+  IS31FL3733_SIM_DEVICE *chip = Setup (&device);
+  
+  // Page is selected once for writes to the same page.
+  IS31FL3733_SetLEDPWM (&device, 0, 0, 10);
+  IS31FL3733_SetLEDPWM (&device, 1, 0, 20);
+  IS31FL3733_SetGCC (&device, 0x80);
+  IS31FL3733_SetSWPUR (&device, IS31FL3733_RESISTOR_1K);
+  CHECK (Test_CountWrites (&sim, IS31FL3733_PSR) == 2);
+  CHECK (sim.transactions == 2 * 2 + 4);
+  CHECK (device.page == IS31FL3733_GET_PAGE(IS31FL3733_GCC));
+  CHECK ((chip->pages[1][0] == 10) && (chip->pages[1][1] == 20));
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0x80);
+  // Reading RESET register makes active page unknown.
+  IS31FL3733_Init (&device);
+  CHECK (device.page != IS31FL3733_GET_PAGE(IS31FL3733_RESET));
+}
+
+static void
+TestBatch (void)
+{
+  IS31FL3733 device;
+  IS31FL3733_SIM_DEVICE *chip = Setup (&device);
+  uint8_t cs;
+  
+  IS31FL3733_SelectPage (&device, IS31FL3733_GET_PAGE(IS31FL3733_LEDPWM));
+  IS31FL3733_Sim_ResetStats (&sim);
+  // Adjacent writes are coalesced into one burst.
+  IS31FL3733_BeginBatch (&device);
+  for (cs = 0; cs < IS31FL3733_CS; cs++)
+  {
+    IS31FL3733_SetLEDPWM (&device, cs, 3, cs + 1);
+  }
+  CHECK (sim.transactions == 0);
+  CHECK (IS31FL3733_EndBatch (&device) == 0);
+  CHECK (sim.transactions == 1);
+  CHECK (IS31FL3733_Sim_GetRecord (&sim, 0)->count == IS31FL3733_CS);
+  for (cs = 0; cs < IS31FL3733_CS; cs++)
+  {
+    CHECK (chip->pages[1][3 * IS31FL3733_CS + cs] == cs + 1);
+  }
+  // Gap between registers starts new burst.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_BeginBatch (&device);
+  IS31FL3733_SetLEDPWM (&device, 0, 5, 1);
+  IS31FL3733_SetLEDPWM (&device, 2, 5, 2);
+  IS31FL3733_EndBatch (&device);
+  CHECK (sim.transactions == 2);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestPageCache);
+  TEST_RUN (TestBatch);
+  return Test_Result ();
+}
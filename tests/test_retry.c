@@ -0,0 +1,76 @@
+/** Retry and resync tests on simulated bus: transient errors are repeated, failed registers are marked stale and written by resync.
+  */
+#include "test.h"
+
+static IS31FL3733_SIM sim;
+
+static IS31FL3733_SIM_DEVICE *
+Setup (IS31FL3733 *device)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (device);
+  IS31FL3733_Sim_ResetStats (&sim);
+  return chip;
+}
+
+static void
+TestRetryResync (void)
+{
+  IS31FL3733 device;
+  IS31FL3733_SIM_DEVICE *chip = Setup (&device);
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint16_t i;
+  
+  // Transient errors are repeated.
+  for (i = 0; i < sizeof(pwm); i++)
+  {
+    pwm[i] = (uint8_t)i;
+  }
+  test_fail_writes = IS31FL3733_RETRIES;
+  IS31FL3733_SetPWM (&device, pwm);
+  CHECK (IS31FL3733_GetStatus (&device) == 0);
+  CHECK (memcmp (chip->pages[1], pwm, sizeof(pwm)) == 0);
+  // Persistent errors are reported and registers are marked stale.
+  test_fail_writes = 1000;
+  IS31FL3733_SetLEDPWM (&device, 3, 4, 77);
+  IS31FL3733_SetLEDState (&device, 5, 6, IS31FL3733_LED_STATE_ON);
+  IS31FL3733_SetGCC (&device, 0x40);
+  CHECK (IS31FL3733_GetStatus (&device) == TEST_ERROR);
+  CHECK (IS31FL3733_GetStatus (&device) == 0);
+  CHECK (device.page == IS31FL3733_PAGE_UNKNOWN);
+  CHECK (device.pwm_dirty[4] & (1 << 3));
+  CHECK (device.leds_stale & (1 << (6 * 2)));
+  CHECK (device.config_stale & (1 << IS31FL3733_GET_ADDR(IS31FL3733_GCC)));
+  // Resync writes stale registers only.
+  test_fail_writes = 0;
+  IS31FL3733_Sim_ResetStats (&sim);
+  CHECK (IS31FL3733_Resync (&device) == 0);
+  CHECK (memcmp (chip->pages[1], device.pwm, sizeof(device.pwm)) == 0);
+  CHECK (memcmp (chip->pages[0], device.leds, sizeof(device.leds)) == 0);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0x40);
+  CHECK ((device.leds_stale == 0) && (device.config_stale == 0));
+  CHECK (sim.transactions < 12);
+  IS31FL3733_Sim_ResetStats (&sim);
+  CHECK (IS31FL3733_Resync (&device) == 0);
+  CHECK (sim.transactions == 0);
+  // Failed batch is written by resync too.
+  IS31FL3733_BeginBatch (&device);
+  IS31FL3733_SetLEDPWM (&device, 0, 0, 99);
+  test_fail_writes = 1000;
+  CHECK (IS31FL3733_EndBatch (&device) == TEST_ERROR);
+  test_fail_writes = 0;
+  IS31FL3733_Resync (&device);
+  CHECK (chip->pages[1][0] == 99);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestRetryResync);
+  return Test_Result ();
+}
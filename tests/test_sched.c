@@ -0,0 +1,177 @@
+/** Shared bus scheduler tests on simulated bus: merging, chunk interleaving and priority.
+  */
+#include "test.h"
+#include "is31fl3733_sched.h"
+
+static IS31FL3733_SIM sim;
+static IS31FL3733_SIM_DEVICE *chips[2];
+static IS31FL3733 devices[2];
+static IS31FL3733_SCHED sched;
+static IS31FL3733_SCHED_PORT *ports[2];
+
+static void
+Setup (uint8_t priority)
+{
+  uint8_t i;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  IS31FL3733_Sched_Init (&sched, &Test_I2CWriteReg, &IS31FL3733_Sim_I2CReadReg);
+  for (i = 0; i < 2; i++)
+  {
+    chips[i] = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, i));
+    Test_InitDevice (&devices[i], IS31FL3733_I2C_ADDR(ADDR_GND, i));
+    ports[i] = IS31FL3733_Sched_Attach (&sched, &devices[i], (i == 1) ? priority : 0);
+    IS31FL3733_Init (&devices[i]);
+  }
+  IS31FL3733_Sched_Run (&sched, 0);
+  IS31FL3733_Sim_ResetStats (&sim);
+}
+
+static void
+TestMerge (void)
+{
+  Setup (0);
+  // Repeated writes of the same register are merged in queue.
+  IS31FL3733_SetLEDPWM (&devices[0], 4, 1, 10);
+  IS31FL3733_SetLEDPWM (&devices[0], 4, 1, 20);
+  IS31FL3733_SetLEDPWM (&devices[0], 4, 1, 30);
+  CHECK (sched.merged == 2);
+  CHECK (sim.transactions == 0);
+  IS31FL3733_Sched_Run (&sched, 0);
+  CHECK (Test_CountWrites (&sim, 1 * IS31FL3733_CS + 4) == 1);
+  CHECK (chips[0]->pages[1][1 * IS31FL3733_CS + 4] == 30);
+  // Page 3 registers are always sent.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_SetGCC (&devices[0], 1);
+  IS31FL3733_SetGCC (&devices[0], 2);
+  IS31FL3733_Sched_Run (&sched, 0);
+  CHECK (Test_CountWrites (&sim, IS31FL3733_GET_ADDR(IS31FL3733_GCC)) == 2);
+  CHECK (chips[0]->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 2);
+}
+
+static void
+TestInterleave (void)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  IS31FL3733_SIM_RECORD *record;
+  uint8_t switches = 0;
+  uint8_t i;
+  uint32_t n;
+  
+  Setup (0);
+  for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS / 2; i++)
+  {
+    pwm[i] = i;
+    pwm[sizeof(pwm) - 1 - i] = i;
+  }
+  // Full frames of both devices are sent in chunks, alternating between devices.
+  IS31FL3733_SetPWM (&devices[0], pwm);
+  IS31FL3733_SetPWM (&devices[1], pwm);
+  IS31FL3733_Sched_Run (&sched, 0);
+  for (n = 1; n < sim.transactions; n++)
+  {
+    record = IS31FL3733_Sim_GetRecord (&sim, n);
+    CHECK (record->count <= IS31FL3733_SCHED_CHUNK);
+    switches += (record->i2c_addr != IS31FL3733_Sim_GetRecord (&sim, n - 1)->i2c_addr);
+  }
+  CHECK (switches >= 2 * IS31FL3733_SW * IS31FL3733_CS / IS31FL3733_SCHED_CHUNK - 2);
+  for (i = 0; i < 2; i++)
+  {
+    CHECK (memcmp (chips[i]->pages[1], pwm, sizeof(pwm)) == 0);
+  }
+}
+
+static void
+TestPriority (void)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS] = {1};
+  
+  Setup (1);
+  // Port with higher priority is sent first, even if it was queued later.
+  IS31FL3733_SetPWM (&devices[0], pwm);
+  IS31FL3733_SetLEDPWM (&devices[1], 0, 0, 5);
+  CHECK (IS31FL3733_Sched_Step (&sched, 0) == 1);
+  CHECK (chips[1]->pages[1][0] == 5);
+  CHECK (chips[0]->pages[1][0] == 0);
+  IS31FL3733_Sched_Run (&sched, 0);
+  CHECK (chips[0]->pages[1][0] == 1);
+  CHECK (IS31FL3733_Sched_Step (&sched, 0) == 0);
+}
+
+static void
+TestMergeOrder (void)
+{
+  IS31FL3733_SIM_RECORD *record;
+  uint8_t order[3];
+  uint8_t n = 0;
+  uint32_t i;
+  
+  Setup (0);
+  // Repeated PWM write is not moved before write to other page.
+  IS31FL3733_SetLEDPWM (&devices[0], 0, 0, 10);
+  IS31FL3733_SetGCC (&devices[0], 0x20);
+  IS31FL3733_SetLEDPWM (&devices[0], 0, 0, 30);
+  CHECK (sched.merged == 0);
+  IS31FL3733_Sched_Run (&sched, 0);
+  for (i = 0; i < sim.transactions; i++)
+  {
+    record = IS31FL3733_Sim_GetRecord (&sim, i);
+    if ((record->reg_addr < IS31FL3733_IMR) && (n < sizeof(order)))
+    {
+      order[n++] = record->data[0];
+    }
+  }
+  CHECK ((n == 3) && (order[0] == 10) && (order[1] == 0x20) && (order[2] == 30));
+  CHECK (chips[0]->pages[1][0] == 30);
+}
+
+static void
+TestFailure (void)
+{
+  uint8_t pwm[IS31FL3733_SW * IS31FL3733_CS];
+  uint16_t i;
+  
+  Setup (0);
+  for (i = 0; i < sizeof(pwm); i++)
+  {
+    pwm[i] = (uint8_t)(i + 1);
+  }
+  // Failed chunks are reported to their device.
+  IS31FL3733_SetPWM (&devices[0], pwm);
+  IS31FL3733_SetGCC (&devices[1], 0x50);
+  test_fail_writes = 1000;
+  IS31FL3733_Sched_Run (&sched, 0);
+  test_fail_writes = 0;
+  CHECK (IS31FL3733_Sched_GetStatus (&sched) == TEST_ERROR);
+  CHECK (IS31FL3733_GetStatus (&devices[0]) == TEST_ERROR);
+  CHECK (IS31FL3733_GetStatus (&devices[1]) == TEST_ERROR);
+  CHECK (devices[0].page == IS31FL3733_PAGE_UNKNOWN);
+  CHECK (devices[0].pwm_dirty[0] == 0xFFFF);
+  CHECK (devices[0].pwm_dirty[IS31FL3733_SW - 1] == 0xFFFF);
+  CHECK (devices[1].config_stale == (1 << IS31FL3733_GET_ADDR(IS31FL3733_GCC)));
+  // Resync through scheduler writes them again.
+  IS31FL3733_Resync (&devices[0]);
+  IS31FL3733_Resync (&devices[1]);
+  IS31FL3733_Sched_Run (&sched, 0);
+  CHECK (memcmp (chips[0]->pages[1], pwm, sizeof(pwm)) == 0);
+  CHECK (chips[1]->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0x50);
+  CHECK (IS31FL3733_GetStatus (&devices[0]) == 0);
+  CHECK (devices[1].config_stale == 0);
+  // Transient errors are repeated.
+  IS31FL3733_SetLEDPWM (&devices[0], 0, 0, 0);
+  test_fail_writes = IS31FL3733_RETRIES;
+  IS31FL3733_Sched_Run (&sched, 0);
+  CHECK (IS31FL3733_Sched_GetStatus (&sched) == 0);
+  CHECK (chips[0]->pages[1][0] == 0);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestMerge);
+  TEST_RUN (TestMergeOrder);
+  TEST_RUN (TestInterleave);
+  TEST_RUN (TestPriority);
+  TEST_RUN (TestFailure);
+  return Test_Result ();
+}
@@ -0,0 +1,163 @@
+/** Frame sequence tests on simulated bus: encode, seek and play round-trip.
+  */
+#include <stdlib.h>
+
+#include "test.h"
+#include "is31fl3733_seq.h"
+
+/// Number of frames and keyframe interval of test sequence.
+#define FRAMES    (24)
+#define KEY_EVERY (8)
+
+static IS31FL3733_SIM sim;
+static uint8_t pwm[FRAMES][IS31FL3733_SW * IS31FL3733_CS];
+static uint8_t leds[FRAMES][IS31FL3733_SW * IS31FL3733_CS / 8];
+static uint8_t sequence[IS31FL3733_SEQ_HEADER_SIZE + FRAMES * IS31FL3733_SEQ_FRAME_MAX + FRAMES / KEY_EVERY * IS31FL3733_SEQ_INDEX_SIZE];
+
+static void
+MakeFrames (void)
+{
+  uint16_t f;
+  uint16_t i;
+  
+  // Frames mix unchanged registers, runs and random values.
+  for (f = 0; f < FRAMES; f++)
+  {
+    for (i = 0; i < IS31FL3733_SW * IS31FL3733_CS; i++)
+    {
+      if ((f != 0) && (rand () % 3 == 0))
+      {
+        pwm[f][i] = pwm[f - 1][i];
+      }
+      else
+      {
+        pwm[f][i] = (i / 16 == f % IS31FL3733_SW) ? 0x55 : (uint8_t)rand ();
+      }
+    }
+    IS31FL3733_PackState (leds[f], pwm[f], 0x20);
+  }
+}
+
+static uint32_t
+Encode (void)
+{
+  uint32_t offset = IS31FL3733_SEQ_HEADER_SIZE;
+  uint32_t index[FRAMES / KEY_EVERY];
+  uint8_t *entry;
+  uint16_t f;
+  
+  for (f = 0; f < FRAMES; f++)
+  {
+    if (f % KEY_EVERY == 0)
+    {
+      index[f / KEY_EVERY] = offset;
+      offset += IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_MAX, pwm[f], NULL, leds[f], NULL, NULL, NULL);
+    }
+    else
+    {
+      offset += IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_MAX, pwm[f], pwm[f - 1], leds[f], leds[f - 1], NULL, NULL);
+    }
+  }
+  IS31FL3733_Seq_EncodeHeader (sequence, 10, FRAMES, FRAMES / KEY_EVERY, offset);
+  for (f = 0; f < FRAMES / KEY_EVERY; f++)
+  {
+    entry = &sequence[offset + f * IS31FL3733_SEQ_INDEX_SIZE];
+    entry[0] = (uint8_t)(f * KEY_EVERY);
+    entry[1] = 0;
+    entry[2] = (uint8_t)index[f];
+    entry[3] = (uint8_t)(index[f] >> 8);
+    entry[4] = (uint8_t)(index[f] >> 16);
+    entry[5] = (uint8_t)(index[f] >> 24);
+  }
+  return offset + FRAMES / KEY_EVERY * IS31FL3733_SEQ_INDEX_SIZE;
+}
+
+static void
+TestRoundTrip (void)
+{
+  IS31FL3733 device;
+  IS31FL3733_SEQ_PLAYER player;
+  IS31FL3733_SIM_DEVICE *chip;
+  uint32_t size;
+  uint16_t f;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  MakeFrames ();
+  size = Encode ();
+  CHECK (IS31FL3733_Seq_Open (&player, &device, sequence, size) == 0);
+  // Every played frame matches source frame in device registers.
+  CHECK (IS31FL3733_Seq_Seek (&player, 0, 0) == IS31FL3733_SEQ_FRAME);
+  for (f = 0; f < FRAMES; f++)
+  {
+    if (f != 0)
+    {
+      CHECK (IS31FL3733_Seq_Play (&player, f * 10 - 1) == IS31FL3733_SEQ_WAIT);
+      CHECK (IS31FL3733_Seq_Play (&player, f * 10) == IS31FL3733_SEQ_FRAME);
+    }
+    CHECK (memcmp (chip->pages[1], pwm[f], sizeof(pwm[f])) == 0);
+    CHECK (memcmp (chip->pages[0], leds[f], sizeof(leds[f])) == 0);
+  }
+  CHECK (IS31FL3733_Seq_Play (&player, FRAMES * 10) == IS31FL3733_SEQ_END);
+  // Seek decodes from nearest keyframe.
+  for (f = FRAMES - 1; f < FRAMES; f -= 5)
+  {
+    CHECK (IS31FL3733_Seq_Seek (&player, f, 0) == IS31FL3733_SEQ_FRAME);
+    CHECK (memcmp (chip->pages[1], pwm[f], sizeof(pwm[f])) == 0);
+    CHECK (memcmp (chip->pages[0], leds[f], sizeof(leds[f])) == 0);
+  }
+  // Truncated sequence is rejected.
+  CHECK (IS31FL3733_Seq_Open (&player, &device, sequence, size - IS31FL3733_SEQ_INDEX_SIZE) != 0);
+}
+
+static void
+TestWorstCase (void)
+{
+  static uint8_t zeros[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t values[IS31FL3733_SW * IS31FL3733_CS];
+  uint8_t *entry;
+  IS31FL3733 device;
+  IS31FL3733_SEQ_PLAYER player;
+  IS31FL3733_SIM_DEVICE *chip;
+  uint32_t offset = IS31FL3733_SEQ_HEADER_SIZE;
+  uint16_t size;
+  uint16_t i;
+  
+  // Registers alternate between changed and unchanged in all sections.
+  for (i = 0; i < sizeof(values); i++)
+  {
+    values[i] = (i % 2 == 0) ? (uint8_t)(i % 3 + 1) : 0;
+  }
+  offset += IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_MAX, zeros, NULL, zeros, NULL, zeros, NULL);
+  size = IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_MAX, values, zeros, values, zeros, values, zeros);
+  CHECK (size == IS31FL3733_SEQ_FRAME_MAX);
+  // Frame that doesn't fit is not encoded.
+  CHECK (IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_MAX - 1, values, zeros, values, zeros, values, zeros) == 0);
+  CHECK (IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_HEADER_SIZE - 1, NULL, NULL, NULL, NULL, NULL, NULL) == 0);
+  size = IS31FL3733_Seq_EncodeFrame (&sequence[offset], IS31FL3733_SEQ_FRAME_MAX, values, zeros, values, zeros, values, zeros);
+  offset += size;
+  // Worst case frame decodes to the same registers.
+  IS31FL3733_Seq_EncodeHeader (sequence, 10, 2, 1, offset);
+  entry = &sequence[offset];
+  memset (entry, 0, IS31FL3733_SEQ_INDEX_SIZE);
+  entry[2] = IS31FL3733_SEQ_HEADER_SIZE;
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  CHECK (IS31FL3733_Seq_Open (&player, &device, sequence, offset + IS31FL3733_SEQ_INDEX_SIZE) == 0);
+  CHECK (IS31FL3733_Seq_Seek (&player, 1, 0) == IS31FL3733_SEQ_FRAME);
+  CHECK (memcmp (chip->pages[1], values, sizeof(values)) == 0);
+  CHECK (memcmp (chip->pages[2], values, sizeof(values)) == 0);
+  CHECK (memcmp (chip->pages[0], values, IS31FL3733_SW * IS31FL3733_CS / 8) == 0);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestRoundTrip);
+  TEST_RUN (TestWorstCase);
+  return Test_Result ();
+}
@@ -0,0 +1,162 @@
+/** Simulator tests on raw I2C transfers: page select lock, register access, reset, detection, interrupts, timing and log.
+  */
+#include "test.h"
+
+#define ADDRESS IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND)
+
+static IS31FL3733_SIM sim;
+
+static void
+WriteReg (uint8_t reg_addr, uint8_t reg_value)
+{
+  IS31FL3733_Sim_I2CWriteReg (ADDRESS, reg_addr, &reg_value, 1);
+}
+
+static uint8_t
+ReadReg (uint8_t reg_addr)
+{
+  uint8_t reg_value = 0xAA;
+  
+  IS31FL3733_Sim_I2CReadReg (ADDRESS, reg_addr, &reg_value, 1);
+  return reg_value;
+}
+
+static void
+SelectPage (uint8_t page)
+{
+  WriteReg (IS31FL3733_PSWL, IS31FL3733_PSWL_ENABLE);
+  WriteReg (IS31FL3733_PSR, page);
+}
+
+static void
+TestPageSelect (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  uint8_t buffer[IS31FL3733_CS];
+  uint8_t i;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, ADDRESS);
+  // Page select is ignored while locked, lock is restored after each page select.
+  WriteReg (IS31FL3733_PSR, 1);
+  CHECK (chip->psr == 0);
+  SelectPage (1);
+  CHECK ((chip->psr == 1) && (chip->pswl == IS31FL3733_PSWL_DISABLE));
+  WriteReg (IS31FL3733_PSR, 2);
+  CHECK (chip->psr == 1);
+  // Nonexistent page is not selected.
+  SelectPage (4);
+  CHECK (chip->psr == 1);
+  // Burst writes consecutive registers of selected page.
+  for (i = 0; i < sizeof(buffer); i++)
+  {
+    buffer[i] = i + 1;
+  }
+  IS31FL3733_Sim_I2CWriteReg (ADDRESS, 2 * IS31FL3733_CS, buffer, sizeof(buffer));
+  CHECK (memcmp (&chip->pages[1][2 * IS31FL3733_CS], buffer, sizeof(buffer)) == 0);
+  CHECK (chip->pages[2][2 * IS31FL3733_CS] == 0);
+  // Registers out of page are not written, write only registers read as zero.
+  WriteReg (IS31FL3733_SW * IS31FL3733_CS, 0x55);
+  CHECK (chip->pages[2][0] == 0);
+  CHECK (ReadReg (2 * IS31FL3733_CS) == 0);
+  CHECK (ReadReg (IS31FL3733_PSR) == 0);
+}
+
+static void
+TestReset (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, ADDRESS);
+  SelectPage (IS31FL3733_GET_PAGE(IS31FL3733_CR));
+  WriteReg (IS31FL3733_GET_ADDR(IS31FL3733_GCC), 0x80);
+  WriteReg (IS31FL3733_IMR, IS31FL3733_IMR_IAB);
+  // Reset register is read only, its read resets all registers.
+  WriteReg (IS31FL3733_GET_ADDR(IS31FL3733_RESET), 0x01);
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0x80);
+  ReadReg (IS31FL3733_GET_ADDR(IS31FL3733_RESET));
+  CHECK (chip->pages[3][IS31FL3733_GET_ADDR(IS31FL3733_GCC)] == 0);
+  CHECK ((chip->psr == 0) && (chip->imr == 0));
+}
+
+static void
+TestDetection (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, ADDRESS);
+  IS31FL3733_Sim_SetLEDStatus (chip, 9, 3, IS31FL3733_LED_STATUS_OPEN);
+  IS31FL3733_Sim_SetLEDStatus (chip, 1, 4, IS31FL3733_LED_STATUS_SHORT);
+  IS31FL3733_Sim_SetLEDStatus (chip, 2, 4, IS31FL3733_LED_STATUS_SHORT);
+  WriteReg (IS31FL3733_IMR, IS31FL3733_IMR_IO | IS31FL3733_IMR_IS);
+  // Only LEDs turned on are detected, on rising edge of OSD bit.
+  SelectPage (IS31FL3733_GET_PAGE(IS31FL3733_LEDONOFF));
+  WriteReg (3 * 2 + 1, 0x02);
+  WriteReg (4 * 2, 0x02);
+  SelectPage (IS31FL3733_GET_PAGE(IS31FL3733_CR));
+  WriteReg (IS31FL3733_GET_ADDR(IS31FL3733_CR), IS31FL3733_CR_OSD);
+  CHECK (IS31FL3733_Sim_GetINTB (chip) == 0);
+  SelectPage (IS31FL3733_GET_PAGE(IS31FL3733_LEDOPEN));
+  CHECK (ReadReg (IS31FL3733_GET_ADDR(IS31FL3733_LEDOPEN) + 3 * 2 + 1) == 0x02);
+  CHECK (ReadReg (IS31FL3733_GET_ADDR(IS31FL3733_LEDSHORT) + 4 * 2) == 0x02);
+  // LED states can't be read back.
+  CHECK (ReadReg (3 * 2 + 1) == 0);
+  // Interrupt status is cleared on read and releases INTB.
+  CHECK (ReadReg (IS31FL3733_ISR) == (IS31FL3733_ISR_OB | IS31FL3733_ISR_SB));
+  CHECK (IS31FL3733_Sim_GetINTB (chip) == 1);
+  CHECK (ReadReg (IS31FL3733_ISR) == 0);
+  // ABM finish is reported only when enabled.
+  IS31FL3733_Sim_FinishABM (chip, 2);
+  CHECK (IS31FL3733_Sim_GetINTB (chip) == 1);
+  WriteReg (IS31FL3733_IMR, IS31FL3733_IMR_IAB);
+  IS31FL3733_Sim_FinishABM (chip, 2);
+  CHECK (ReadReg (IS31FL3733_ISR) == IS31FL3733_ISR_ABM2);
+}
+
+static void
+TestTimingLog (void)
+{
+  uint8_t buffer[4] = { 1, 2, 3, 4 };
+  IS31FL3733_SIM_RECORD *record;
+  uint32_t i;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  IS31FL3733_Sim_AddDevice (&sim, ADDRESS);
+  // Write: START, address, register, data and STOP bits at bus clock.
+  IS31FL3733_Sim_I2CWriteReg (ADDRESS, 0x10, buffer, sizeof(buffer));
+  CHECK (sim.bytes == 2 + 4);
+  CHECK (sim.time == (uint64_t)(1 + 9 + 9 + 9 * 4 + 1) * 1000000000 / 400000);
+  record = IS31FL3733_Sim_GetRecord (&sim, 0);
+  CHECK ((record->reg_addr == 0x10) && (record->count == 4) && !record->read && (record->status == 0));
+  CHECK (memcmp (record->data, buffer, sizeof(buffer)) == 0);
+  // Read adds repeated START and address.
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_Sim_I2CReadReg (ADDRESS, IS31FL3733_ISR, buffer, 1);
+  CHECK (sim.bytes == 3 + 1);
+  CHECK (sim.time == (uint64_t)(1 + 9 + 9 + 1 + 9 + 9 + 1) * 1000000000 / 400000);
+  // Unknown address is not acknowledged.
+  IS31FL3733_Sim_ResetStats (&sim);
+  CHECK (IS31FL3733_Sim_I2CWriteReg (IS31FL3733_I2C_ADDR(ADDR_VCC, ADDR_VCC), 0x10, buffer, 1) == IS31FL3733_SIM_NACK);
+  CHECK (sim.bytes == 1);
+  // Log keeps last records, record 0 is the oldest of them.
+  IS31FL3733_Sim_ResetStats (&sim);
+  for (i = 0; i < IS31FL3733_SIM_LOG_SIZE + 3; i++)
+  {
+    WriteReg ((uint8_t)i, 0);
+  }
+  CHECK (IS31FL3733_Sim_GetRecord (&sim, 0)->reg_addr == 3);
+  CHECK (IS31FL3733_Sim_GetRecord (&sim, IS31FL3733_SIM_LOG_SIZE - 1)->reg_addr == (uint8_t)(IS31FL3733_SIM_LOG_SIZE + 2));
+  CHECK (IS31FL3733_Sim_GetRecord (&sim, IS31FL3733_SIM_LOG_SIZE) == NULL);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestPageSelect);
+  TEST_RUN (TestReset);
+  TEST_RUN (TestDetection);
+  TEST_RUN (TestTimingLog);
+  return Test_Result ();
+}
@@ -0,0 +1,159 @@
+/** LED state packing tests on simulated bus: SSE2 and scalar paths match reference, nibble order, writes of changed registers only.
+  * run_tests.sh builds this test once more with SSE2 disabled to check scalar path on the same host.
+  */
+#include <stdlib.h>
+
+#include "test.h"
+
+#define LEDS (IS31FL3733_SW * IS31FL3733_CS)
+
+static IS31FL3733_SIM sim;
+static IS31FL3733 device;
+
+/// Reference packing, one LED at a time.
+static void
+PackReference (uint8_t *leds, const uint8_t *values, uint8_t threshold)
+{
+  uint8_t i;
+  
+  memset (leds, 0, LEDS / 8);
+  for (i = 0; i < LEDS; i++)
+  {
+    if (values[i] > threshold)
+    {
+      leds[i / 8] |= 0x01 << (i % 8);
+    }
+  }
+}
+
+static void
+TestParity (void)
+{
+  static const uint8_t thresholds[] = { 0x00, 0x7F, 0x80, 0xFF };
+  uint8_t values[LEDS];
+  uint8_t leds[LEDS / 8];
+  uint8_t expected[LEDS / 8];
+  uint8_t t;
+  uint8_t n;
+  uint8_t i;
+  
+#if defined(__SSE2__)
+  printf ("SSE2 path\n");
+#else
+  printf ("scalar path\n");
+#endif
+  srand (3733);
+  for (t = 0; t < sizeof(thresholds); t++)
+  {
+    for (n = 0; n < 32; n++)
+    {
+      for (i = 0; i < LEDS; i++)
+      {
+        // Random frames, every fourth is built around threshold and sign bit.
+        switch ((n % 4 == 3) ? rand () % 4 : 4)
+        {
+          case 0:
+            values[i] = thresholds[t];
+            break;
+          case 1:
+            values[i] = thresholds[t] + 1;
+            break;
+          case 2:
+            values[i] = (rand () & 1) ? 0x80 : 0x7F;
+            break;
+          case 3:
+            values[i] = (rand () & 1) ? 0xFF : 0x00;
+            break;
+          default:
+            values[i] = (uint8_t)rand ();
+            break;
+        }
+      }
+      IS31FL3733_PackState (leds, values, thresholds[t]);
+      PackReference (expected, values, thresholds[t]);
+      CHECK (memcmp (leds, expected, sizeof(leds)) == 0);
+    }
+  }
+}
+
+static void
+TestNibbleOrder (void)
+{
+  uint8_t values[LEDS / 2];
+  uint8_t unpacked[LEDS];
+  uint8_t leds[LEDS / 8];
+  uint8_t expected[LEDS / 8];
+  uint8_t i;
+  
+  // High nibble is the first LED of each byte.
+  memset (values, 0, sizeof(values));
+  values[0] = 0xF0;
+  values[1] = 0x0F;
+  values[sizeof(values) - 1] = 0x80;
+  IS31FL3733_PackState4 (leds, values, 0x07);
+  CHECK ((leds[0] == 0x09) && (leds[sizeof(leds) - 1] == 0x40));
+  // Random frame matches 8 bits per LED frame with the same values.
+  for (i = 0; i < sizeof(values); i++)
+  {
+    values[i] = (uint8_t)rand ();
+    unpacked[i * 2] = values[i] >> 4;
+    unpacked[i * 2 + 1] = values[i] & 0x0F;
+  }
+  for (i = 0; i < 0x10; i++)
+  {
+    IS31FL3733_PackState4 (leds, values, i);
+    PackReference (expected, unpacked, i);
+    CHECK (memcmp (leds, expected, sizeof(leds)) == 0);
+  }
+}
+
+static void
+TestChangedWrites (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  IS31FL3733_SIM_RECORD *record;
+  uint8_t values[LEDS];
+  uint8_t expected[LEDS / 8];
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  memset (values, 0x40, sizeof(values));
+  IS31FL3733_SetStateThreshold (&device, values, 0x3F);
+  CHECK (chip->pages[0][0] == 0xFF);
+  IS31FL3733_Sim_ResetStats (&sim);
+  // Values changed on the same side of threshold write nothing.
+  memset (values, 0x90, sizeof(values));
+  IS31FL3733_SetStateThreshold (&device, values, 0x3F);
+  CHECK (sim.transactions == 0);
+  // Single crossing LED writes its register only.
+  values[5 * IS31FL3733_CS + 12] = 0x3F;
+  IS31FL3733_SetStateThreshold (&device, values, 0x3F);
+  CHECK (sim.transactions == 1);
+  record = IS31FL3733_Sim_GetRecord (&sim, 0);
+  CHECK ((record->reg_addr == (5 << 1) + 1) && (record->count == 1) && (record->data[0] == 0xEF));
+  PackReference (expected, values, 0x3F);
+  CHECK (memcmp (chip->pages[0], expected, sizeof(expected)) == 0);
+  CHECK (memcmp (device.leds, expected, sizeof(expected)) == 0);
+  // 4 bits per LED frame writes changed registers only too.
+  IS31FL3733_Sim_ResetStats (&sim);
+  memset (values, 0xFF, LEDS / 2);
+  values[(5 * IS31FL3733_CS + 12) / 2] = 0x0F;
+  IS31FL3733_SetStateThreshold4 (&device, values, 0x00);
+  CHECK (sim.transactions == 0);
+  values[0] = 0x0F;
+  IS31FL3733_SetStateThreshold4 (&device, values, 0x00);
+  CHECK (sim.transactions == 1);
+  record = IS31FL3733_Sim_GetRecord (&sim, 0);
+  CHECK ((record->reg_addr == 0) && (record->count == 1) && (record->data[0] == 0xFE));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestParity);
+  TEST_RUN (TestNibbleOrder);
+  TEST_RUN (TestChangedWrites);
+  return Test_Result ();
+}
@@ -0,0 +1,152 @@
+/** Bus statistics tests on simulated bus: counters, errors, latency histogram, get and reset.
+  * Driver and test must be built with IS31FL3733_USE_STATS defined, run_tests.sh adds it for this test.
+  */
+#include "test.h"
+
+#ifndef IS31FL3733_USE_STATS
+#error "test_stats requires IS31FL3733_USE_STATS"
+#endif
+
+static IS31FL3733_SIM sim;
+static IS31FL3733 device;
+/// Fake clock ticks.
+static uint32_t ticks;
+/// Ticks added by each write transfer.
+static uint32_t write_ticks;
+
+static uint32_t
+FakeClock (void)
+{
+  return ticks;
+}
+
+static uint8_t
+SlowWrite (uint8_t i2c_addr, uint8_t reg_addr, uint8_t *buffer, uint8_t count)
+{
+  ticks += write_ticks;
+  return Test_I2CWriteReg (i2c_addr, reg_addr, buffer, count);
+}
+
+static void
+Setup (void)
+{
+  IS31FL3733_Sim_Init (&sim, 400000);
+  IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  test_fail_writes = 0;
+  IS31FL3733_Init (&device);
+  IS31FL3733_Sim_ResetStats (&sim);
+  IS31FL3733_ResetStats (&device);
+}
+
+/// Sum of register values in logged transactions.
+static uint32_t
+LoggedBytes (void)
+{
+  uint32_t bytes = 0;
+  uint32_t n;
+  
+  for (n = 0; n < sim.transactions; n++)
+  {
+    bytes += IS31FL3733_Sim_GetRecord (&sim, n)->count;
+  }
+  return bytes;
+}
+
+static void
+TestCounters (void)
+{
+  uint8_t leds[IS31FL3733_SW * IS31FL3733_CS / 8];
+  
+  Setup ();
+  // Init counts from reset.
+  CHECK ((device.stats.transactions == 0) && (device.stats.page_switches == 0));
+  // Page select is counted once for writes to the same page.
+  IS31FL3733_SetLEDPWM (&device, 0, 0, 10);
+  IS31FL3733_SetLEDPWM (&device, 1, 0, 20);
+  IS31FL3733_SetLEDPWM (&device, IS31FL3733_CS, 1, 30);
+  IS31FL3733_SetGCC (&device, 0x80);
+  CHECK (device.stats.page_switches == 2);
+  CHECK (device.stats.transactions == sim.transactions);
+  CHECK (device.stats.transactions == 2 * 2 + 4);
+  CHECK (device.stats.bytes == LoggedBytes ());
+  CHECK (device.stats.bytes == 2 * 2 + 1 + 1 + IS31FL3733_CS + 1);
+  CHECK (device.stats.errors == 0);
+  // Unchanged shadow values are elided.
+  IS31FL3733_UpdateLEDPWM (&device, 0, 0, 10);
+  IS31FL3733_UpdateLEDPWM (&device, 1, 0, 21);
+  CHECK (device.stats.elided == 1);
+  IS31FL3733_UpdateLEDPWM (&device, IS31FL3733_CS, 1, 30);
+  CHECK (device.stats.elided == 1 + IS31FL3733_CS);
+  memcpy (leds, device.leds, sizeof(leds));
+  leds[3] = 0x01;
+  IS31FL3733_SetStatePacked (&device, leds);
+  CHECK (device.stats.elided == 1 + IS31FL3733_CS + sizeof(leds) - 1);
+}
+
+static void
+TestErrors (void)
+{
+  IS31FL3733_STATS stats;
+  
+  Setup ();
+  IS31FL3733_SetGCC (&device, 0x80);
+  IS31FL3733_ResetStats (&device);
+  // Each failed attempt is counted.
+  test_fail_writes = 1;
+  IS31FL3733_SetGCC (&device, 0x40);
+  CHECK ((device.stats.transactions == 2) && (device.stats.errors == 1));
+  test_fail_writes = 1000;
+  IS31FL3733_SetGCC (&device, 0x20);
+  test_fail_writes = 0;
+  IS31FL3733_GetStats (&device, &stats);
+  CHECK (stats.transactions == 2 + IS31FL3733_RETRIES + 1);
+  CHECK (stats.errors == 1 + IS31FL3733_RETRIES + 1);
+  CHECK (stats.page_switches == 0);
+  // Reset clears all counters.
+  IS31FL3733_ResetStats (&device);
+  IS31FL3733_GetStats (&device, &stats);
+  CHECK ((stats.transactions == 0) && (stats.bytes == 0) && (stats.errors == 0) && (stats.elided == 0) && (stats.page_switches == 0));
+}
+
+static void
+TestLatency (void)
+{
+  static const uint32_t durations[] = { 0, 1, 2, 3, 4, 7, 8, 0x8000, 0xFFFFFFFF };
+  static const uint8_t buckets[] = { 0, 1, 2, 2, 3, 3, 4, IS31FL3733_STATS_BUCKETS - 1, IS31FL3733_STATS_BUCKETS - 1 };
+  uint32_t expected[IS31FL3733_STATS_BUCKETS];
+  IS31FL3733_STATS stats;
+  uint8_t i;
+  
+  Setup ();
+  device.i2c_write_reg = &SlowWrite;
+  IS31FL3733_SetGCC (&device, 0x80);
+  // Without clock histogram is not collected.
+  IS31FL3733_ResetStats (&device);
+  IS31FL3733_SetGCC (&device, 0x81);
+  IS31FL3733_GetStats (&device, &stats);
+  CHECK ((stats.transactions == 1) && (stats.latency[0] == 0));
+  // Call durations are counted in logarithmic buckets, counting wraps with clock.
+  device.clock = &FakeClock;
+  ticks = 0xFFFFFFF0;
+  IS31FL3733_ResetStats (&device);
+  memset (expected, 0, sizeof(expected));
+  for (i = 0; i < sizeof(durations) / sizeof(durations[0]); i++)
+  {
+    write_ticks = durations[i];
+    IS31FL3733_SetGCC (&device, i);
+    expected[buckets[i]]++;
+  }
+  IS31FL3733_GetStats (&device, &stats);
+  CHECK (memcmp (stats.latency, expected, sizeof(expected)) == 0);
+  CHECK (stats.transactions == sizeof(durations) / sizeof(durations[0]));
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestCounters);
+  TEST_RUN (TestErrors);
+  TEST_RUN (TestLatency);
+  return Test_Result ();
+}
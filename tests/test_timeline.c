@@ -0,0 +1,104 @@
+/** Timeline and ABM manager tests on simulated bus: ABM functions are taken only by effects assigned to LEDs, releases and effect indexes are checked.
+  */
+#include "test.h"
+#include "is31fl3733_timeline.h"
+
+static IS31FL3733_SIM sim;
+static IS31FL3733 device;
+static IS31FL3733_TIMELINE timeline;
+
+static void
+TestUnusedEffects (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  IS31FL3733_EFFECT effect;
+  uint8_t used = IS31FL3733_TIMELINE_NONE;
+  uint8_t i;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  IS31FL3733_Timeline_Init (&timeline, &device);
+  // Breath effects with different timings, each could run in its own ABM function.
+  memset (&effect, 0, sizeof(effect));
+  effect.type = IS31FL3733_EFFECT_BREATH;
+  effect.to = 0x80;
+  effect.T3 = 210;
+  effect.Times = IS31FL3733_ABM_LOOP_FOREVER;
+  for (i = 0; i < IS31FL3733_ABM_SLOTS + 1; i++)
+  {
+    effect.T1 = 210 << i;
+    used = IS31FL3733_Timeline_AddEffect (&timeline, &effect);
+  }
+  // Only last effect is assigned, it runs in hardware.
+  IS31FL3733_Timeline_Assign (&timeline, 4, 2, used);
+  CHECK (IS31FL3733_Timeline_Start (&timeline, 0) == 1);
+  CHECK (timeline.modes[used] == IS31FL3733_LED_MODE_ABM1);
+  CHECK (timeline.abm.refs[0] == 1);
+  CHECK ((timeline.abm.refs[1] == 0) && (timeline.abm.refs[2] == 0));
+  CHECK (chip->pages[2][2 * IS31FL3733_CS + 4] == IS31FL3733_LED_MODE_ABM1);
+  CHECK (chip->pages[1][2 * IS31FL3733_CS + 4] == 0x80);
+}
+
+static void
+TestRelease (void)
+{
+  IS31FL3733_ABM config;
+  
+  memset (&config, 0, sizeof(config));
+  IS31FL3733_ABMManager_Init (&timeline.abm, &device);
+  CHECK (IS31FL3733_ABMManager_Request (&timeline.abm, &config) == IS31FL3733_LED_MODE_ABM1);
+  // PWM, invalid modes and releases of free functions don't change references.
+  IS31FL3733_ABMManager_Release (&timeline.abm, IS31FL3733_LED_MODE_PWM);
+  IS31FL3733_ABMManager_Release (&timeline.abm, (IS31FL3733_LED_MODE)0x04);
+  IS31FL3733_ABMManager_Release (&timeline.abm, (IS31FL3733_LED_MODE)0xFF);
+  IS31FL3733_ABMManager_Release (&timeline.abm, IS31FL3733_LED_MODE_ABM2);
+  CHECK ((timeline.abm.refs[0] == 1) && (timeline.abm.refs[1] == 0) && (timeline.abm.refs[2] == 0));
+  IS31FL3733_ABMManager_Release (&timeline.abm, IS31FL3733_LED_MODE_ABM1);
+  IS31FL3733_ABMManager_Release (&timeline.abm, IS31FL3733_LED_MODE_ABM1);
+  CHECK (timeline.abm.refs[0] == 0);
+}
+
+static void
+TestInvalidEffect (void)
+{
+  IS31FL3733_SIM_DEVICE *chip;
+  IS31FL3733_EFFECT effect;
+  uint8_t index;
+  
+  IS31FL3733_Sim_Init (&sim, 400000);
+  chip = IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  Test_InitDevice (&device, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  IS31FL3733_Init (&device);
+  IS31FL3733_Timeline_Init (&timeline, &device);
+  memset (&effect, 0, sizeof(effect));
+  effect.type = IS31FL3733_EFFECT_CONSTANT;
+  effect.to = 0x40;
+  index = IS31FL3733_Timeline_AddEffect (&timeline, &effect);
+  IS31FL3733_Timeline_Assign (&timeline, 0, 0, index);
+  // Indexes out of timeline don't change assignment.
+  IS31FL3733_Timeline_Assign (&timeline, 0, 0, index + 1);
+  IS31FL3733_Timeline_Assign (&timeline, 1, 0, IS31FL3733_TIMELINE_EFFECTS);
+  IS31FL3733_Timeline_Assign (&timeline, 2, 0, 0xFE);
+  CHECK (timeline.leds[0] == index);
+  CHECK ((timeline.leds[1] == IS31FL3733_TIMELINE_NONE) && (timeline.leds[2] == IS31FL3733_TIMELINE_NONE));
+  // LEDs with index out of timeline are not animated.
+  timeline.leds[3] = 0xFE;
+  CHECK (IS31FL3733_Timeline_Start (&timeline, 0) == 0);
+  IS31FL3733_Timeline_Tick (&timeline, 100);
+  CHECK (chip->pages[1][0] == 0x40);
+  CHECK ((chip->pages[1][3] == 0x00) && (chip->pages[2][3] == IS31FL3733_LED_MODE_PWM));
+  // Unassign is accepted.
+  IS31FL3733_Timeline_Assign (&timeline, 0, 0, IS31FL3733_TIMELINE_NONE);
+  CHECK (timeline.leds[0] == IS31FL3733_TIMELINE_NONE);
+}
+
+int
+main (void)
+{
+  TEST_RUN (TestUnusedEffects);
+  TEST_RUN (TestRelease);
+  TEST_RUN (TestInvalidEffect);
+  return Test_Result ();
+}
@@ -0,0 +1,150 @@
+/** IS31FL3733 driver benchmark on simulated bus.
+  * Prints CSV with number of transactions, bytes on bus and maximum call rate
+  * at 100 kHz, 400 kHz and 1 MHz bus clock for each public function.
+  * Cold run is the first call with unknown active page, including page select.
+  * Steady run repeats the same call with its page already selected.
+  *
+  * Build on host:
+  *   cc -I. -o is31fl3733_bench tools/is31fl3733_bench.c is31fl3733.c is31fl3733_abm.c is31fl3733_sim.c
+  */
+#include <stdio.h>
+
+#include "is31fl3733.h"
+#include "is31fl3733_abm.h"
+#include "is31fl3733_sim.h"
+
+/// Bus clock used for measurement. At 1 MHz one bit takes exactly 1000 ns.
+#define BENCH_CLOCK (1000000)
+
+static IS31FL3733_SIM sim;
+static IS31FL3733 device;
+static uint8_t frame[IS31FL3733_SW * IS31FL3733_CS];
+static uint8_t states[IS31FL3733_SW * IS31FL3733_CS];
+static uint8_t packed[IS31FL3733_SW * IS31FL3733_CS / 8];
+static IS31FL3733_ABM abm;
+static IS31FL3733_ABM_MANAGER manager;
+
+static void bench_led_pwm_single (void) { IS31FL3733_SetLEDPWM (&device, 5, 7, 128); }
+static void bench_led_pwm_row (void) { IS31FL3733_SetLEDPWM (&device, IS31FL3733_CS, 7, 128); }
+static void bench_led_pwm_column (void) { IS31FL3733_SetLEDPWM (&device, 5, IS31FL3733_SW, 128); }
+static void bench_led_pwm_all (void) { IS31FL3733_SetLEDPWM (&device, IS31FL3733_CS, IS31FL3733_SW, 128); }
+static void bench_led_state_single (void) { IS31FL3733_SetLEDState (&device, 5, 7, IS31FL3733_LED_STATE_ON); }
+static void bench_led_state_row (void) { IS31FL3733_SetLEDState (&device, IS31FL3733_CS, 7, IS31FL3733_LED_STATE_ON); }
+static void bench_led_state_column (void) { IS31FL3733_SetLEDState (&device, 5, IS31FL3733_SW, IS31FL3733_LED_STATE_ON); }
+static void bench_led_state_all (void) { IS31FL3733_SetLEDState (&device, IS31FL3733_CS, IS31FL3733_SW, IS31FL3733_LED_STATE_ON); }
+static void bench_pwm (void) { IS31FL3733_SetPWM (&device, frame); }
+static void bench_state (void) { unsigned int i; for (i = 0; i < sizeof(states); i++) { states[i] ^= 1; } IS31FL3733_SetState (&device, states); }
+static void bench_state_unchanged (void) { IS31FL3733_SetState (&device, states); }
+static void bench_state_packed (void) { packed[0] ^= 1; IS31FL3733_SetStatePacked (&device, packed); }
+static void bench_led_status (void) { IS31FL3733_GetLEDStatus (&device, 5, 7); }
+static void bench_delay (uint32_t ms) { (void)ms; }
+static void bench_scan_leds (void) { IS31FL3733_LED_SCAN scan; IS31FL3733_ScanLEDs (&device, &scan, bench_delay); }
+static void bench_led_mode_single (void) { IS31FL3733_SetLEDMode (&device, 5, 7, IS31FL3733_LED_MODE_ABM1); }
+static void bench_led_mode_row (void) { IS31FL3733_SetLEDMode (&device, IS31FL3733_CS, 7, IS31FL3733_LED_MODE_ABM1); }
+static void bench_led_mode_column (void) { IS31FL3733_SetLEDMode (&device, 5, IS31FL3733_SW, IS31FL3733_LED_MODE_ABM1); }
+static void bench_led_mode_all (void) { IS31FL3733_SetLEDMode (&device, IS31FL3733_CS, IS31FL3733_SW, IS31FL3733_LED_MODE_ABM1); }
+static void bench_config_abm (void) { IS31FL3733_ConfigABM (&device, IS31FL3733_ABM_NUM_1, &abm); }
+static void bench_start_abm (void) { IS31FL3733_StartABM (&device); }
+static void bench_abm_apply (void) { manager.configs[0].Times ^= 1; IS31FL3733_ABMManager_Apply (&manager); }
+
+/** Benchmark case.
+  */
+typedef struct {
+  /// Function name.
+  const char *name;
+  /// Mode of operation.
+  const char *mode;
+  /// Benchmark function.
+  void (*run) (void);
+} BENCH_CASE;
+
+static const BENCH_CASE cases[] = {
+  { "IS31FL3733_SetLEDPWM",    "single", bench_led_pwm_single },
+  { "IS31FL3733_SetLEDPWM",    "row",    bench_led_pwm_row },
+  { "IS31FL3733_SetLEDPWM",    "column", bench_led_pwm_column },
+  { "IS31FL3733_SetLEDPWM",    "all",    bench_led_pwm_all },
+  { "IS31FL3733_SetLEDState",  "single", bench_led_state_single },
+  { "IS31FL3733_SetLEDState",  "row",    bench_led_state_row },
+  { "IS31FL3733_SetLEDState",  "column", bench_led_state_column },
+  { "IS31FL3733_SetLEDState",  "all",    bench_led_state_all },
+  { "IS31FL3733_SetPWM",       "frame",  bench_pwm },
+  { "IS31FL3733_SetState",     "frame",  bench_state },
+  { "IS31FL3733_SetState",     "unchanged", bench_state_unchanged },
+  { "IS31FL3733_SetStatePacked", "single", bench_state_packed },
+  { "IS31FL3733_GetLEDStatus", "single", bench_led_status },
+  { "IS31FL3733_ScanLEDs",     "all",    bench_scan_leds },
+  { "IS31FL3733_SetLEDMode",   "single", bench_led_mode_single },
+  { "IS31FL3733_SetLEDMode",   "row",    bench_led_mode_row },
+  { "IS31FL3733_SetLEDMode",   "column", bench_led_mode_column },
+  { "IS31FL3733_SetLEDMode",   "all",    bench_led_mode_all },
+  { "IS31FL3733_ConfigABM",    "single", bench_config_abm },
+  { "IS31FL3733_StartABM",     "single", bench_start_abm },
+  { "IS31FL3733_ABMManager_Apply", "all", bench_abm_apply },
+};
+
+static void
+bench_print (const BENCH_CASE *bench, const char *run)
+{
+  unsigned long bits;
+  
+  bits = (unsigned long)(sim.time / (1000000000 / BENCH_CLOCK));
+  // Function did not use bus.
+  if (bits == 0)
+  {
+    printf ("%s,%s,%s,0,0,0,,,\n", bench->name, bench->mode, run);
+    return;
+  }
+  printf ("%s,%s,%s,%lu,%lu,%lu,%.1f,%.1f,%.1f\n", bench->name, bench->mode, run,
+          (unsigned long)sim.transactions, (unsigned long)sim.bytes, bits,
+          100000.0 / bits, 400000.0 / bits, 1000000.0 / bits);
+}
+
+int
+main (void)
+{
+  unsigned int i;
+  
+  // Connect device to simulated bus.
+  IS31FL3733_Sim_Init (&sim, BENCH_CLOCK);
+  IS31FL3733_Sim_AddDevice (&sim, IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND));
+  device.address = IS31FL3733_I2C_ADDR(ADDR_GND, ADDR_GND);
+  device.i2c_write_reg = &IS31FL3733_Sim_I2CWriteReg;
+  device.i2c_read_reg = &IS31FL3733_Sim_I2CReadReg;
+  IS31FL3733_Init (&device);
+  // Prepare frame and ABM configuration.
+  for (i = 0; i < sizeof(frame); i++)
+  {
+    frame[i] = (uint8_t)i;
+    states[i] = 1;
+  }
+  abm.T1 = IS31FL3733_ABM_T1_840MS;
+  abm.T2 = IS31FL3733_ABM_T2_840MS;
+  abm.T3 = IS31FL3733_ABM_T3_840MS;
+  abm.T4 = IS31FL3733_ABM_T4_840MS;
+  abm.Tbegin = IS31FL3733_ABM_LOOP_BEGIN_T4;
+  abm.Tend = IS31FL3733_ABM_LOOP_END_T3;
+  abm.Times = IS31FL3733_ABM_LOOP_FOREVER;
+  // Use all ABM functions.
+  IS31FL3733_ABMManager_Init (&manager, &device);
+  for (i = 0; i < IS31FL3733_ABM_SLOTS; i++)
+  {
+    abm.T4 = (IS31FL3733_ABM_T4)(IS31FL3733_ABM_T4_210MS + i * 2);
+    IS31FL3733_ABMManager_Request (&manager, &abm);
+  }
+  abm.T4 = IS31FL3733_ABM_T4_840MS;
+  
+  printf ("function,mode,run,transactions,bytes,bits,fps_100khz,fps_400khz,fps_1mhz\n");
+  for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+  {
+    // Cold cost: first call selects its page, e.g. after other page was used or after reset.
+    device.page = IS31FL3733_PAGE_UNKNOWN;
+    IS31FL3733_Sim_ResetStats (&sim);
+    cases[i].run ();
+    bench_print (&cases[i], "cold");
+    // Steady state cost: the same call again with its page selected.
+    IS31FL3733_Sim_ResetStats (&sim);
+    cases[i].run ();
+    bench_print (&cases[i], "steady");
+  }
+  return 0;
+}
@@ -0,0 +1,73 @@
+/** IS31FL3733 command list generator.
+  * Records register writes showing 192 byte PWM frame in register order and prints them as C array
+  * for IS31FL3733_Cmd_Replay. LED is turned on if its PWM value is not zero.
+  *
+  * Build on host:
+  *   cc -I. -o is31fl3733_cmdgen tools/is31fl3733_cmdgen.c is31fl3733.c is31fl3733_cmd.c
+  *
+  * Usage:
+  *   is31fl3733_cmdgen frame.raw name [gcc] > name.h
+  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "is31fl3733.h"
+#include "is31fl3733_cmd.h"
+
+/// Command list buffer size: page selects, GCC, PWM and LED states.
+#define LIST_SIZE (1024)
+
+int
+main (int argc, char *argv[])
+{
+  static uint8_t list[LIST_SIZE];
+  uint8_t frame[IS31FL3733_SW * IS31FL3733_CS + 1];
+  IS31FL3733_RECORDER recorder;
+  IS31FL3733 device;
+  unsigned long gcc = 0xFF;
+  uint16_t length;
+  uint16_t i;
+  FILE *input;
+  
+  if (argc < 3)
+  {
+    fprintf (stderr, "Usage: %s frame.raw name [gcc]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 3)
+  {
+    gcc = strtoul (argv[3], NULL, 0);
+  }
+  // Read frame.
+  input = fopen (argv[1], "rb");
+  if ((input == NULL) || (fread (frame, 1, sizeof(frame), input) != IS31FL3733_SW * IS31FL3733_CS) || (gcc > 0xFF))
+  {
+    fprintf (stderr, "%s: expected %d byte frame and GCC up to 255\n", argv[1], IS31FL3733_SW * IS31FL3733_CS);
+    return 1;
+  }
+  fclose (input);
+  // Device state at replay is unknown: LED states must differ from shadow to be recorded.
+  memset (&device, 0, sizeof(device));
+  IS31FL3733_PackState (device.leds, frame, 0);
+  for (i = 0; i < sizeof(device.leds); i++)
+  {
+    device.leds[i] = (uint8_t)~device.leds[i];
+  }
+  device.brightness = 255;
+  // Record frame.
+  IS31FL3733_Cmd_StartRecord (&recorder, &device, list, sizeof(list));
+  IS31FL3733_SetGCC (&device, (uint8_t)gcc);
+  IS31FL3733_SetPWM (&device, frame);
+  IS31FL3733_SetState (&device, frame);
+  length = IS31FL3733_Cmd_StopRecord (&recorder);
+  // Print command list.
+  printf ("/* Generated by is31fl3733_cmdgen from %s. */\n", argv[1]);
+  printf ("const uint8_t %s[%u] = {", argv[2], length);
+  for (i = 0; i < length; i++)
+  {
+    printf ("%s0x%02X,", (i % 16) ? "" : "\n  ", list[i]);
+  }
+  printf ("\n};\n");
+  return 0;
+}
@@ -0,0 +1,133 @@
+/** IS31FL3733 frame sequence encoder.
+  * Converts raw file of 192 byte PWM frames in register order to delta-encoded sequence.
+  * LED is turned on in frames where its PWM value is not zero.
+  *
+  * Build on host:
+  *   cc -I. -o is31fl3733_seqenc tools/is31fl3733_seqenc.c is31fl3733.c is31fl3733_abm.c is31fl3733_seq.c
+  *
+  * Usage:
+  *   is31fl3733_seqenc input.raw output.seq [period_ms] [keyframe_interval]
+  */
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "is31fl3733_seq.h"
+
+/// Size of raw PWM frame.
+#define FRAME_SIZE (IS31FL3733_SW * IS31FL3733_CS)
+
+/// Default frame period, ms.
+#define DEFAULT_PERIOD (33)
+
+/// Default number of frames between keyframes.
+#define DEFAULT_KEYFRAME_INTERVAL (64)
+
+int
+main (int argc, char *argv[])
+{
+  uint8_t header[IS31FL3733_SEQ_HEADER_SIZE];
+  uint8_t frame[IS31FL3733_SEQ_FRAME_MAX];
+  uint8_t entry[IS31FL3733_SEQ_INDEX_SIZE];
+  uint8_t leds[2][FRAME_SIZE / 8];
+  const uint8_t *input;
+  uint32_t *index;
+  uint32_t offset = IS31FL3733_SEQ_HEADER_SIZE;
+  unsigned long period = DEFAULT_PERIOD;
+  unsigned long interval = DEFAULT_KEYFRAME_INTERVAL;
+  unsigned long count;
+  unsigned long keyframes = 0;
+  unsigned long i;
+  uint16_t size;
+  struct stat st;
+  FILE *output;
+  int fd;
+  
+  if (argc < 3)
+  {
+    fprintf (stderr, "Usage: %s input.raw output.seq [period_ms] [keyframe_interval]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 3)
+  {
+    period = strtoul (argv[3], NULL, 0);
+  }
+  if (argc > 4)
+  {
+    interval = strtoul (argv[4], NULL, 0);
+  }
+  // Map input file.
+  fd = open (argv[1], O_RDONLY);
+  if ((fd < 0) || (fstat (fd, &st) != 0) || (st.st_size == 0) || (st.st_size % FRAME_SIZE != 0))
+  {
+    fprintf (stderr, "%s: not a raw frame file\n", argv[1]);
+    return 1;
+  }
+  count = (unsigned long)st.st_size / FRAME_SIZE;
+  if ((count > 0xFFFF) || (period == 0) || (period > 0xFFFF) || (interval == 0))
+  {
+    fprintf (stderr, "Invalid number of frames, period or keyframe interval\n");
+    return 1;
+  }
+  input = mmap (NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (input == MAP_FAILED)
+  {
+    perror ("mmap");
+    return 1;
+  }
+  index = malloc (sizeof(uint32_t) * ((count + interval - 1) / interval));
+  output = fopen (argv[2], "wb");
+  if ((index == NULL) || (output == NULL))
+  {
+    perror (argv[2]);
+    return 1;
+  }
+  // Header is written again when index offset is known.
+  fwrite (header, 1, sizeof(header), output);
+  for (i = 0; i < count; i++)
+  {
+    IS31FL3733_PackState (leds[i & 1], &input[i * FRAME_SIZE], 0);
+    if (i % interval == 0)
+    {
+      // Keyframe.
+      index[keyframes++] = offset;
+      size = IS31FL3733_Seq_EncodeFrame (frame, sizeof(frame), &input[i * FRAME_SIZE], NULL, leds[i & 1], NULL, NULL, NULL);
+    }
+    else
+    {
+      // Delta frame against previous frame.
+      size = IS31FL3733_Seq_EncodeFrame (frame, sizeof(frame), &input[i * FRAME_SIZE], &input[(i - 1) * FRAME_SIZE], leds[i & 1], leds[(i - 1) & 1], NULL, NULL);
+    }
+    if (size == 0)
+    {
+      fprintf (stderr, "Frame %lu doesn't fit into frame buffer\n", i);
+      return 1;
+    }
+    fwrite (frame, 1, size, output);
+    offset += size;
+  }
+  // Write keyframe index.
+  for (i = 0; i < keyframes; i++)
+  {
+    entry[0] = (uint8_t)(i * interval);
+    entry[1] = (uint8_t)((i * interval) >> 8);
+    entry[2] = (uint8_t)index[i];
+    entry[3] = (uint8_t)(index[i] >> 8);
+    entry[4] = (uint8_t)(index[i] >> 16);
+    entry[5] = (uint8_t)(index[i] >> 24);
+    fwrite (entry, 1, sizeof(entry), output);
+  }
+  IS31FL3733_Seq_EncodeHeader (header, (uint16_t)period, (uint16_t)count, (uint16_t)keyframes, offset);
+  fseek (output, 0, SEEK_SET);
+  fwrite (header, 1, sizeof(header), output);
+  fclose (output);
+  printf ("%lu frames, %lu keyframes, %lu bytes from %lu bytes\n", count, keyframes,
+          (unsigned long)(offset + keyframes * IS31FL3733_SEQ_INDEX_SIZE), (unsigned long)st.st_size);
+  free (index);
+  munmap ((void *)input, (size_t)st.st_size);
+  close (fd);
+  return 0;
+}